@@ -0,0 +1,43 @@
+#include "argument_stack.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kChunkSize = 4096;
+
+}  // namespace
+
+ArgumentStack::Frame::Frame(ArgumentStack* stack, size_t count)
+    : stack_(stack), saved_chunk_(stack->current_), saved_top_(stack->top_) {
+    args_ = std::span<Object*>(stack->Allocate(count), count);
+}
+
+ArgumentStack::Frame::~Frame() {
+    stack_->current_ = saved_chunk_;
+    stack_->top_ = saved_top_;
+}
+
+std::span<Object*> ArgumentStack::Frame::GetArgs() const {
+    return args_;
+}
+
+// A frame that does not fit into the rest of the current chunk starts the
+// next one; chunks above the current one are free, so a too small one can
+// simply be replaced.
+Object** ArgumentStack::Allocate(size_t count) {
+    if (chunks_.empty() || top_ + count > chunks_[current_].size) {
+        size_t next = chunks_.empty() ? 0 : current_ + 1;
+        size_t size = std::max(kChunkSize, count);
+        if (next == chunks_.size()) {
+            chunks_.push_back(Chunk{std::make_unique<Object*[]>(size), size});
+        } else if (chunks_[next].size < count) {
+            chunks_[next] = Chunk{std::make_unique<Object*[]>(size), size};
+        }
+        current_ = next;
+        top_ = 0;
+    }
+    auto data = chunks_[current_].data.get() + top_;
+    top_ += count;
+    return data;
+}
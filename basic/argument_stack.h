@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "object.h"
+
+// Stack the tree walker evaluates call arguments into, owned by the
+// Interpreter and reused by every call. Frames are carved out of large
+// chunks and never move, so a special form can keep reading its arguments
+// while evaluating further calls on top of them.
+class ArgumentStack {
+public:
+    // Room for count arguments on top of the stack, released when the frame
+    // is destroyed. Frames must be destroyed in reverse order of creation.
+    class Frame {
+    public:
+        Frame(ArgumentStack* stack, size_t count);
+        ~Frame();
+
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+
+        std::span<Object*> GetArgs() const;
+
+    private:
+        ArgumentStack* stack_;
+        size_t saved_chunk_;
+        size_t saved_top_;
+        std::span<Object*> args_;
+    };
+
+private:
+    struct Chunk {
+        std::unique_ptr<Object*[]> data;
+        size_t size;
+    };
+
+    Object** Allocate(size_t count);
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    size_t top_ = 0;
+};
@@ -0,0 +1,82 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "mapped_file.h"
+
+namespace {
+
+// Workers take sources in runs of this many, so that claiming work costs
+// next to nothing while a slow run still cannot hold up the others for long.
+constexpr size_t kClaimSize = 16;
+
+size_t CountWorkers(size_t requested, size_t sources) {
+    if (requested == 0) {
+        requested = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(1, std::min(requested, sources));
+}
+
+// Blank by the tokenizer's rules, which take nothing but spaces and newlines
+// for whitespace.
+bool IsBlank(std::string_view line) {
+    return line.find_first_not_of(" \n") == std::string_view::npos;
+}
+
+}  // namespace
+
+std::vector<BatchResult> RunBatch(std::span<const std::string> sources,
+                                  const BatchOptions& options) {
+    std::vector<BatchResult> results(sources.size());
+    std::atomic<size_t> next = 0;
+
+    // Each result slot is written by the one worker that claimed it, and
+    // read only after every worker has been joined.
+    auto work = [&] {
+        Interpreter interpreter{options.interpreter};
+        while (true) {
+            size_t begin = next.fetch_add(kClaimSize, std::memory_order_relaxed);
+            if (begin >= sources.size()) {
+                return;
+            }
+            size_t end = std::min(begin + kClaimSize, sources.size());
+            for (size_t i = begin; i < end; ++i) {
+                try {
+                    results[i].output = interpreter.Run(sources[i]);
+                } catch (...) {
+                    results[i].error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    // The calling thread is one of the workers.
+    size_t workers = CountWorkers(options.threads, sources.size());
+    std::vector<std::jthread> threads;
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    threads.clear();
+    return results;
+}
+
+std::vector<BatchResult> RunBatchFile(const std::string& path, const BatchOptions& options) {
+    MappedFile file(path);
+    auto data = file.GetData();
+    std::vector<std::string> sources;
+    while (!data.empty()) {
+        auto end = std::min(data.find('\n'), data.size());
+        auto line = data.substr(0, end);
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (!IsBlank(line)) {
+            sources.emplace_back(line);
+        }
+        data.remove_prefix(std::min(end + 1, data.size()));
+    }
+    return RunBatch(sources, options);
+}
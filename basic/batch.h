@@ -0,0 +1,34 @@
+#pragma once
+
+#include <exception>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "scheme.h"
+
+struct BatchOptions {
+    // Worker threads; 0 means one per hardware thread. Never more than there
+    // are sources.
+    size_t threads = 0;
+
+    // Every worker evaluates on its own Interpreter, made with these options.
+    InterpreterOptions interpreter;
+};
+
+// What Interpreter::Run returned for one source, or the exception it threw.
+struct BatchResult {
+    std::string output;
+    std::exception_ptr error;
+};
+
+// Evaluates independent sources across worker threads and returns their
+// results in input order. Which worker, and so which interpreter, gets a
+// source is unspecified, so sources must not rely on one another.
+std::vector<BatchResult> RunBatch(std::span<const std::string> sources,
+                                  const BatchOptions& options = {});
+
+// The same for a file holding one source per line. Lines may end in "\r\n"
+// as well as "\n". Blank lines, of nothing but spaces, are skipped and get
+// no result.
+std::vector<BatchResult> RunBatchFile(const std::string& path, const BatchOptions& options = {});
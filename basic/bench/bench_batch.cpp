@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <batch.h>
+
+// A batch of 4096 distinct requests on state.range(0) workers, timed by the
+// wall clock.
+static void BM_RunBatch(benchmark::State& state) {
+    std::vector<std::string> sources;
+    for (int i = 0; i < 4096; ++i) {
+        auto n = std::to_string(i);
+        sources.push_back("(+ (* " + n + " (max 1 2 3)) (- 10 (abs -" + n + ")) (min " + n +
+                          " (* 3 4)) (length '(1 2 3 " + n + ")))");
+    }
+    BatchOptions options;
+    options.threads = state.range(0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RunBatch(sources, options));
+    }
+    state.SetItemsProcessed(state.iterations() * sources.size());
+}
+BENCHMARK(BM_RunBatch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
@@ -0,0 +1,282 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <argument_stack.h>
+#include <big_int.h>
+#include <builtins.h>
+#include <bytecode.h>
+#include <error.h>
+#include <fuzzer.h>
+#include <heap.h>
+#include <numeric_kernels.h>
+#include <parser.h>
+#include <profiler.h>
+#include <scheme.h>
+#include <tokenizer.h>
+
+static constexpr const char* kExpression =
+    "(+ (* 2 (max 1 2 3)) (- 10 (abs -4)) (and #t (or #f 5)) (min (+ 1 2) (* 3 4)))";
+
+class EvalFixture {
+public:
+    explicit EvalFixture(const std::string& expression = kExpression) {
+        Tokenizer tokenizer{std::string_view(expression)};
+        ast_ = Read(&tokenizer, &symbols_, &heap_);
+        heap_.AddRoot(&ast_);
+    }
+
+    Object* GetAst() const {
+        return ast_;
+    }
+    const Builtins& GetBuiltins() const {
+        return builtins_;
+    }
+    Context* GetContext() {
+        return &context_;
+    }
+    Function* GetFunction(std::string_view name) {
+        return builtins_.Find(*symbols_.Intern(name));
+    }
+
+private:
+    Heap heap_{HeapOptions{.min_collect_bytes = size_t{1} << 40}};
+    SymbolTable symbols_;
+    Builtins builtins_{&symbols_};
+    ArgumentStack arguments_;
+    Context context_{&builtins_, &heap_, &arguments_};
+    Object* ast_ = nullptr;
+};
+
+static void BM_EvalTreeWalk(benchmark::State& state) {
+    EvalFixture fixture;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.GetAst()->Eval(fixture.GetContext()));
+    }
+}
+BENCHMARK(BM_EvalTreeWalk);
+
+static void BM_EvalBytecode(benchmark::State& state) {
+    EvalFixture fixture;
+    auto program = Compile(fixture.GetAst(), fixture.GetBuiltins());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Execute(program, fixture.GetContext()));
+    }
+}
+BENCHMARK(BM_EvalBytecode);
+
+// A flat builtin call with state.range(0) arguments, through the tree walker.
+static void BM_EvalSum(benchmark::State& state) {
+    std::string expression = "(+";
+    for (int i = 0; i < state.range(0); ++i) {
+        expression += " " + std::to_string(i);
+    }
+    EvalFixture fixture{expression + ")"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.GetAst()->Eval(fixture.GetContext()));
+    }
+}
+BENCHMARK(BM_EvalSum)->Arg(2)->Arg(8)->Arg(32);
+
+// A variadic builtin on state.range(0) increasing numbers, through the tree
+// walker.
+static void BM_EvalVariadic(benchmark::State& state, const char* name) {
+    std::string expression = std::string("(") + name;
+    for (int i = 0; i < state.range(0); ++i) {
+        expression += " " + std::to_string(1000 + i);
+    }
+    EvalFixture fixture{expression + ")"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.GetAst()->Eval(fixture.GetContext()));
+    }
+}
+BENCHMARK_CAPTURE(BM_EvalVariadic, plus, "+")->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_EvalVariadic, max, "max")->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_EvalVariadic, less, "<")->RangeMultiplier(4)->Range(2, 512);
+
+// A variadic builtin applied straight to state.range(0) increasing numbers,
+// without evaluating anything.
+static void BM_ApplyVariadic(benchmark::State& state, const char* name) {
+    EvalFixture fixture{"0"};
+    auto function = fixture.GetFunction(name);
+    std::vector<Object*> args;
+    for (int i = 0; i < state.range(0); ++i) {
+        args.push_back(MakeNumber(fixture.GetContext()->heap, 1000 + i));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(function->Apply(fixture.GetContext(), args));
+    }
+}
+BENCHMARK_CAPTURE(BM_ApplyVariadic, plus, "+")->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_ApplyVariadic, max, "max")->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_ApplyVariadic, less, "<")->RangeMultiplier(4)->Range(2, 512);
+
+// The numeric kernels alone on state.range(0) unboxed values, once for every
+// SIMD level.
+static void BM_NumericKernels(benchmark::State& state, SimdLevel level) {
+    if (level > DetectSimdLevel()) {
+        state.SkipWithError("not supported on this CPU");
+        return;
+    }
+    const auto& kernels = GetNumericKernels(level);
+    std::vector<int64_t> values(state.range(0));
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = 1000 + i;
+    }
+    int64_t sum;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernels.sum(values.data(), values.size(), &sum));
+        benchmark::DoNotOptimize(kernels.max(values.data(), values.size()));
+        benchmark::DoNotOptimize(kernels.less(values.data(), values.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_NumericKernels, scalar, SimdLevel::kScalar)->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_NumericKernels, sse42, SimdLevel::kSse42)->RangeMultiplier(4)->Range(2, 512);
+BENCHMARK_CAPTURE(BM_NumericKernels, avx2, SimdLevel::kAvx2)->RangeMultiplier(4)->Range(2, 512);
+
+// Product of two state.range(0)-digit numbers; Karatsuba takes over from
+// schoolbook multiplication at about 300 digits.
+static void BM_BigIntMultiply(benchmark::State& state) {
+    std::string digits(state.range(0), '7');
+    auto lhs = BigInt::FromString(digits);
+    auto rhs = -BigInt::FromString(digits);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs * rhs);
+    }
+}
+BENCHMARK(BM_BigIntMultiply)->RangeMultiplier(4)->Range(16, 16384);
+
+// Run on the same request over and over, with the expression cache off
+// (argument 0) and on.
+static void BM_RunRepeated(benchmark::State& state) {
+    InterpreterOptions options;
+    options.cache_capacity = state.range(0);
+    Interpreter interpreter{options};
+    std::string request = kExpression;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interpreter.Run(request));
+    }
+}
+BENCHMARK(BM_RunRepeated)->Arg(0)->Arg(1024);
+
+// Additions nested state.range(0) deep, through the tree walker and the VM.
+static std::string MakeChain(int64_t depth) {
+    std::string expression;
+    for (int64_t i = 0; i < depth; ++i) {
+        expression += i % 2 ? "(- " + std::to_string(i) + " " : "(+ 1 ";
+    }
+    expression += "1";
+    expression.append(depth, ')');
+    return expression;
+}
+
+static void BM_EvalChainTreeWalk(benchmark::State& state) {
+    EvalFixture fixture{MakeChain(state.range(0))};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.GetAst()->Eval(fixture.GetContext()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EvalChainTreeWalk)->RangeMultiplier(8)->Range(8, 512);
+
+static void BM_EvalChainBytecode(benchmark::State& state) {
+    EvalFixture fixture{MakeChain(state.range(0))};
+    auto program = Compile(fixture.GetAst(), fixture.GetBuiltins());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Execute(program, fixture.GetContext()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EvalChainBytecode)->RangeMultiplier(8)->Range(8, 512);
+
+// A list builtin on a quoted list of state.range(0) numbers, and on the
+// index of its middle if indexed. Quoted lists are stored flat, so none of
+// these should grow with the length. Results that are fresh objects are left
+// for the heap, which never collects here.
+static void BM_ListOp(benchmark::State& state, const char* name, bool indexed) {
+    std::string expression = std::string("(") + name + " '(";
+    for (int i = 0; i < state.range(0); ++i) {
+        expression += std::to_string(i) + " ";
+    }
+    expression += ")";
+    if (indexed) {
+        expression += " " + std::to_string(state.range(0) / 2);
+    }
+    EvalFixture fixture{expression + ")"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.GetAst()->Eval(fixture.GetContext()));
+    }
+}
+BENCHMARK_CAPTURE(BM_ListOp, length, "length", false)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_CAPTURE(BM_ListOp, list_ref, "list-ref", true)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_CAPTURE(BM_ListOp, list_tail, "list-tail", true)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// map allocates its result, so it goes through Run, whose collections keep
+// the heap small. Parsing the list is part of the time.
+static void BM_Map(benchmark::State& state) {
+    std::string expression = "(map abs '(";
+    for (int i = 0; i < state.range(0); ++i) {
+        expression += std::to_string(-i) + " ";
+    }
+    expression += "))";
+    Interpreter interpreter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interpreter.Run(expression));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Map)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// Requests from the fuzzing tests run end to end, errors included, through
+// the tree walker (argument 0) and the VM.
+static void BM_RunFuzz(benchmark::State& state) {
+    Fuzzer fuzzer;
+    std::vector<std::string> requests;
+    for (int i = 0; i < 4096; ++i) {
+        requests.push_back(fuzzer.Next());
+    }
+    InterpreterOptions options;
+    options.use_bytecode = state.range(0) != 0;
+    Interpreter interpreter{options};
+    for (auto _ : state) {
+        for (const auto& request : requests) {
+            try {
+                benchmark::DoNotOptimize(interpreter.Run(request));
+            } catch (const SyntaxError&) {
+            } catch (const RuntimeError&) {
+            } catch (const NameError&) {
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_RunFuzz)->Arg(0)->Arg(1);
+
+// Run with instrumentation off (argument 0) and on.
+static void BM_RunInstrumented(benchmark::State& state) {
+    InterpreterOptions options;
+    options.instrument = state.range(0) != 0;
+    Interpreter interpreter{options};
+    std::string request = kExpression;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interpreter.Run(request));
+    }
+}
+BENCHMARK(BM_RunInstrumented)->Arg(0)->Arg(1);
+
+// Run without a profiler (argument 0) and with one sampling every
+// millisecond.
+static void BM_RunProfiled(benchmark::State& state) {
+    SamplingProfiler profiler;
+    InterpreterOptions options;
+    options.profiler = state.range(0) != 0 ? &profiler : nullptr;
+    Interpreter interpreter{options};
+    std::string request = kExpression;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interpreter.Run(request));
+    }
+    state.counters["samples"] = profiler.GetSampleCount();
+}
+BENCHMARK(BM_RunProfiled)->Arg(0)->Arg(1);
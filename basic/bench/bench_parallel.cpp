@@ -0,0 +1,27 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <scheme.h>
+
+// map against parallel-map with state.range(0) threads over a list of 100000
+// numbers, timed by the wall clock. Parsing and printing the list is part of
+// both.
+static void BM_ParallelMap(benchmark::State& state) {
+    std::string list = "'(";
+    for (int i = 0; i < 100000; ++i) {
+        list += std::to_string(-i) + " ";
+    }
+    list += ")";
+    size_t threads = state.range(0);
+    auto request = (threads == 0 ? "(map abs " : "(parallel-map abs ") + list + ")";
+    InterpreterOptions options;
+    options.cache_capacity = 0;
+    options.parallel_threads = threads;
+    Interpreter interpreter{options};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(interpreter.Run(request));
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(BM_ParallelMap)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <error.h>
+#include <fuzzer.h>
+#include <heap.h>
+#include <parser.h>
+#include <symbol_table.h>
+#include <tokenizer.h>
+
+// Parses source into an arena over and over, so neither the heap nor the
+// collector takes part.
+static void ParseRepeatedly(benchmark::State& state, const std::string& source) {
+    SymbolTable symbols;
+    Heap heap;
+    std::pmr::monotonic_buffer_resource arena;
+    for (auto _ : state) {
+        Tokenizer tokenizer{std::string_view(source)};
+        benchmark::DoNotOptimize(Read(&tokenizer, &symbols, &heap, &arena));
+        arena.release();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+// A flat quoted list of state.range(0) elements.
+static void BM_ParseWide(benchmark::State& state) {
+    std::string source = "'(";
+    for (int i = 0; i < state.range(0); ++i) {
+        source += i % 2 ? "x " : std::to_string(i) + " ";
+    }
+    ParseRepeatedly(state, source + ")");
+}
+BENCHMARK(BM_ParseWide)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// state.range(0) lists, each the only element of the one around it.
+static void BM_ParseDeep(benchmark::State& state) {
+    std::string source(state.range(0), '(');
+    source += "1";
+    source.append(state.range(0), ')');
+    ParseRepeatedly(state, source);
+}
+BENCHMARK(BM_ParseDeep)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// A 1 MB stream of small quoted lists handed to a PushReader in chunks of
+// state.range(0) bytes, with the datums dropped and collected as they come.
+static void BM_PushRead(benchmark::State& state) {
+    std::string source;
+    for (int i = 0; source.size() < (1 << 20); ++i) {
+        source += "'(" + std::to_string(i) + " x (y . -7)) ";
+    }
+    SymbolTable symbols;
+    Heap heap;
+    std::vector<Object*> datums;
+    for (auto _ : state) {
+        PushReader reader(&symbols, &heap);
+        for (size_t i = 0; i < source.size(); i += state.range(0)) {
+            reader.Feed(std::string_view(source).substr(i, state.range(0)), &datums);
+            datums.clear();
+            if (!reader.HasOpenDatum()) {
+                heap.MaybeCollect();
+            }
+        }
+        reader.Finish(&datums);
+        datums.clear();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_PushRead)->RangeMultiplier(64)->Range(64, 1 << 18);
+
+// Requests from the fuzzing tests, most of them malformed.
+static void BM_ParseFuzz(benchmark::State& state) {
+    Fuzzer fuzzer;
+    std::vector<std::string> requests;
+    size_t bytes = 0;
+    for (int i = 0; i < 4096; ++i) {
+        requests.push_back(fuzzer.Next());
+        bytes += requests.back().size();
+    }
+    SymbolTable symbols;
+    Heap heap;
+    std::pmr::monotonic_buffer_resource arena;
+    for (auto _ : state) {
+        for (const auto& request : requests) {
+            try {
+                Tokenizer tokenizer{std::string_view(request)};
+                benchmark::DoNotOptimize(Read(&tokenizer, &symbols, &heap, &arena));
+            } catch (const SyntaxError&) {
+            }
+            arena.release();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_ParseFuzz);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <heap.h>
+#include <parser.h>
+#include <printer.h>
+#include <symbol_table.h>
+#include <tokenizer.h>
+
+// Prints the list source parses to into a string over and over.
+static void PrintRepeatedly(benchmark::State& state, const std::string& source) {
+    SymbolTable symbols;
+    Heap heap;
+    Tokenizer tokenizer{std::string_view(source)};
+    auto list = Read(&tokenizer, &symbols, &heap);
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        Printer printer(&out);
+        list->Print(&printer);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+// A flat list of state.range(0) numbers and symbols.
+static void BM_PrintWide(benchmark::State& state) {
+    std::string source = "(";
+    for (int i = 0; i < state.range(0); ++i) {
+        source += i % 2 ? "x " : std::to_string(i * 7919) + " ";
+    }
+    PrintRepeatedly(state, source + ")");
+}
+BENCHMARK(BM_PrintWide)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// A list of state.range(0) nested lists, each with a dotted tail.
+static void BM_PrintNested(benchmark::State& state) {
+    std::string source = "(";
+    for (int i = 0; i < state.range(0); ++i) {
+        source += "(1 (2 3) . 4) ";
+    }
+    PrintRepeatedly(state, source + ")");
+}
+BENCHMARK(BM_PrintNested)->RangeMultiplier(16)->Range(16, 1 << 16);
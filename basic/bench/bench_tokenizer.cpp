@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <tokenizer.h>
+
+static std::string MakeSource(size_t size) {
+    static const char* kTokens[] = {"(", ")", "'", ".", "42", "-17", "+", "list-tail", "#t", "x1"};
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<size_t> pick(0, std::size(kTokens) - 1);
+    std::string source;
+    while (source.size() < size) {
+        source += kTokens[pick(rng)];
+        source += ' ';
+    }
+    return source;
+}
+
+static void BM_TokenizeStream(benchmark::State& state) {
+    auto source = MakeSource(state.range(0));
+    for (auto _ : state) {
+        std::stringstream ss{source};
+        Tokenizer tokenizer{&ss};
+        size_t count = 0;
+        while (!tokenizer.IsEnd()) {
+            benchmark::DoNotOptimize(tokenizer.GetToken());
+            tokenizer.Next();
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_TokenizeStream)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_TokenizeBuffer(benchmark::State& state) {
+    auto source = MakeSource(state.range(0));
+    for (auto _ : state) {
+        Tokenizer tokenizer{std::string_view{source}};
+        size_t count = 0;
+        while (!tokenizer.IsEnd()) {
+            benchmark::DoNotOptimize(tokenizer.GetToken());
+            tokenizer.Next();
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_TokenizeBuffer)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMillisecond);
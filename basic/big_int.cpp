@@ -0,0 +1,371 @@
+#include "big_int.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <span>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+using LimbSpan = std::span<const uint32_t>;
+
+// Below this many limbs in the shorter operand schoolbook multiplication wins.
+constexpr size_t kKaratsubaThreshold = 32;
+
+constexpr uint32_t kDecimalChunk = 1000000000;
+constexpr size_t kDecimalChunkDigits = 9;
+
+void Trim(Limbs* limbs) {
+    while (!limbs->empty() && limbs->back() == 0) {
+        limbs->pop_back();
+    }
+}
+
+LimbSpan Trimmed(LimbSpan limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs = limbs.first(limbs.size() - 1);
+    }
+    return limbs;
+}
+
+int CompareMagnitude(LimbSpan lhs, LimbSpan rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    for (size_t i = lhs.size(); i-- > 0;) {
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Adds value, shifted up by shift limbs, into *acc.
+void AddInto(Limbs* acc, LimbSpan value, size_t shift) {
+    if (acc->size() < shift + value.size()) {
+        acc->resize(shift + value.size());
+    }
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < value.size(); ++i) {
+        uint64_t sum = uint64_t{(*acc)[shift + i]} + value[i] + carry;
+        (*acc)[shift + i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (i += shift; carry != 0; ++i) {
+        if (i == acc->size()) {
+            acc->push_back(0);
+        }
+        uint64_t sum = uint64_t{(*acc)[i]} + carry;
+        (*acc)[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+// Subtracts value from *acc, which must not be smaller.
+void SubtractFrom(Limbs* acc, LimbSpan value) {
+    int64_t borrow = 0;
+    for (size_t i = 0; i < acc->size(); ++i) {
+        if (i >= value.size() && borrow == 0) {
+            break;
+        }
+        int64_t diff = int64_t{(*acc)[i]} - (i < value.size() ? value[i] : 0) - borrow;
+        borrow = diff < 0;
+        (*acc)[i] = static_cast<uint32_t>(diff);
+    }
+    assert(borrow == 0);
+    Trim(acc);
+}
+
+Limbs AddMagnitude(LimbSpan lhs, LimbSpan rhs) {
+    Limbs res(lhs.begin(), lhs.end());
+    AddInto(&res, rhs, 0);
+    return res;
+}
+
+Limbs SubtractMagnitude(LimbSpan lhs, LimbSpan rhs) {
+    Limbs res(lhs.begin(), lhs.end());
+    SubtractFrom(&res, rhs);
+    return res;
+}
+
+Limbs MultiplySchoolbook(LimbSpan lhs, LimbSpan rhs) {
+    Limbs res(lhs.size() + rhs.size());
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.size(); ++j) {
+            uint64_t cur = uint64_t{lhs[i]} * rhs[j] + res[i + j] + carry;
+            res[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        res[i + rhs.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(&res);
+    return res;
+}
+
+Limbs MultiplyMagnitude(LimbSpan lhs, LimbSpan rhs) {
+    lhs = Trimmed(lhs);
+    rhs = Trimmed(rhs);
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    if (rhs.size() < kKaratsubaThreshold) {
+        return MultiplySchoolbook(lhs, rhs);
+    }
+
+    Limbs res;
+    if (rhs.size() <= lhs.size() / 2) {
+        // Far apart in length: multiply rhs by lhs in pieces of its own size
+        // so that every product is balanced.
+        for (size_t offset = 0; offset < lhs.size(); offset += rhs.size()) {
+            auto piece = lhs.subspan(offset, std::min(rhs.size(), lhs.size() - offset));
+            AddInto(&res, MultiplyMagnitude(piece, rhs), offset);
+        }
+        Trim(&res);
+        return res;
+    }
+
+    // lhs = high * B^half + low, the same for rhs, and
+    // lhs * rhs = z2 * B^2half + (z1 - z2 - z0) * B^half + z0.
+    size_t half = lhs.size() / 2;
+    auto lhs_low = lhs.first(half);
+    auto lhs_high = lhs.subspan(half);
+    auto rhs_low = rhs.first(half);
+    auto rhs_high = rhs.subspan(half);
+
+    auto z0 = MultiplyMagnitude(lhs_low, rhs_low);
+    auto z2 = MultiplyMagnitude(lhs_high, rhs_high);
+    auto z1 = MultiplyMagnitude(AddMagnitude(lhs_low, lhs_high), AddMagnitude(rhs_low, rhs_high));
+    SubtractFrom(&z1, z0);
+    SubtractFrom(&z1, z2);
+
+    res.resize(lhs.size() + rhs.size());
+    AddInto(&res, z0, 0);
+    AddInto(&res, z1, half);
+    AddInto(&res, z2, 2 * half);
+    Trim(&res);
+    return res;
+}
+
+// Divides *limbs by divisor in place and returns the remainder.
+uint32_t DivideBySmall(Limbs* limbs, uint32_t divisor) {
+    uint64_t rem = 0;
+    for (size_t i = limbs->size(); i-- > 0;) {
+        uint64_t cur = (rem << 32) | (*limbs)[i];
+        (*limbs)[i] = static_cast<uint32_t>(cur / divisor);
+        rem = cur % divisor;
+    }
+    Trim(limbs);
+    return static_cast<uint32_t>(rem);
+}
+
+void MultiplyAddSmall(Limbs* limbs, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (auto& limb : *limbs) {
+        uint64_t cur = uint64_t{limb} * factor + carry;
+        limb = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    if (carry != 0) {
+        limbs->push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// Knuth's algorithm D: schoolbook long division, one quotient limb at a time,
+// with the divisor normalized so that each limb estimate is off by at most
+// two.
+Limbs DivideMagnitude(LimbSpan dividend, LimbSpan divisor) {
+    if (CompareMagnitude(dividend, divisor) < 0) {
+        return {};
+    }
+    if (divisor.size() == 1) {
+        Limbs res(dividend.begin(), dividend.end());
+        DivideBySmall(&res, divisor[0]);
+        return res;
+    }
+
+    size_t n = divisor.size();
+    size_t m = dividend.size();
+    int shift = std::countl_zero(divisor.back());
+    auto shifted = [shift](LimbSpan limbs, size_t i) {
+        uint64_t low = i > 0 ? uint64_t{limbs[i - 1]} >> (32 - shift) : 0;
+        uint64_t high = i < limbs.size() ? uint64_t{limbs[i]} << shift : 0;
+        return static_cast<uint32_t>(high | low);
+    };
+    Limbs v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = shifted(divisor, i);
+    }
+    Limbs u(m + 1);
+    for (size_t i = 0; i <= m; ++i) {
+        u[i] = shifted(dividend, i);
+    }
+
+    constexpr uint64_t kBase = uint64_t{1} << 32;
+    Limbs quotient(m - n + 1);
+    for (size_t j = m - n + 1; j-- > 0;) {
+        uint64_t top = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+        uint64_t qhat = top / v[n - 1];
+        uint64_t rhat = top % v[n - 1];
+        while (qhat >= kBase || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= kBase) {
+                break;
+            }
+        }
+
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t product = qhat * v[i];
+            int64_t diff = int64_t{u[i + j]} - borrow - static_cast<int64_t>(product & 0xFFFFFFFF);
+            u[i + j] = static_cast<uint32_t>(diff);
+            borrow = static_cast<int64_t>(product >> 32) - (diff >> 32);
+        }
+        int64_t diff = int64_t{u[j + n]} - borrow;
+        u[j + n] = static_cast<uint32_t>(diff);
+
+        quotient[j] = static_cast<uint32_t>(qhat);
+        if (diff < 0) {
+            // The estimate was one too large: add the divisor back.
+            --quotient[j];
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = uint64_t{u[i + j]} + v[i] + carry;
+                u[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            u[j + n] += static_cast<uint32_t>(carry);
+        }
+    }
+    Trim(&quotient);
+    return quotient;
+}
+
+uint64_t LowMagnitude(const std::vector<uint32_t>& limbs) {
+    uint64_t res = 0;
+    for (size_t i = std::min<size_t>(limbs.size(), 2); i-- > 0;) {
+        res = (res << 32) | limbs[i];
+    }
+    return res;
+}
+
+}  // namespace
+
+BigInt::BigInt(int64_t value) : negative_(value < 0) {
+    uint64_t magnitude = negative_ ? uint64_t{0} - static_cast<uint64_t>(value) : value;
+    limbs_ = {static_cast<uint32_t>(magnitude), static_cast<uint32_t>(magnitude >> 32)};
+    Trim(&limbs_);
+}
+
+BigInt::BigInt(std::vector<uint32_t> limbs, bool negative) : limbs_(std::move(limbs)) {
+    Trim(&limbs_);
+    negative_ = negative && !limbs_.empty();
+}
+
+BigInt BigInt::FromString(std::string_view text) {
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+    Limbs limbs;
+    while (!text.empty()) {
+        size_t len = text.size() % kDecimalChunkDigits;
+        if (len == 0) {
+            len = kDecimalChunkDigits;
+        }
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t i = 0; i < len; ++i) {
+            chunk = chunk * 10 + (text[i] - '0');
+            scale *= 10;
+        }
+        MultiplyAddSmall(&limbs, scale, chunk);
+        text.remove_prefix(len);
+    }
+    return BigInt(std::move(limbs), negative);
+}
+
+bool BigInt::IsNegative() const {
+    return negative_;
+}
+
+bool BigInt::IsZero() const {
+    return limbs_.empty();
+}
+
+bool BigInt::FitsInt64() const {
+    if (limbs_.size() > 2) {
+        return false;
+    }
+    uint64_t magnitude = LowMagnitude(limbs_);
+    uint64_t limit = uint64_t{1} << 63;
+    return negative_ ? magnitude <= limit : magnitude < limit;
+}
+
+int64_t BigInt::ToInt64() const {
+    assert(FitsInt64());
+    uint64_t magnitude = LowMagnitude(limbs_);
+    return static_cast<int64_t>(negative_ ? uint64_t{0} - magnitude : magnitude);
+}
+
+std::string BigInt::ToString() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+    std::vector<uint32_t> chunks;
+    Limbs rest = limbs_;
+    while (!rest.empty()) {
+        chunks.push_back(DivideBySmall(&rest, kDecimalChunk));
+    }
+    std::string res = negative_ ? "-" : "";
+    res += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        auto digits = std::to_string(chunks[i]);
+        res.append(kDecimalChunkDigits - digits.size(), '0');
+        res += digits;
+    }
+    return res;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(limbs_, !negative_);
+}
+
+BigInt BigInt::Abs() const {
+    return BigInt(limbs_, false);
+}
+
+BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+    if (lhs.negative_ == rhs.negative_) {
+        return BigInt(AddMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_);
+    }
+    if (CompareMagnitude(lhs.limbs_, rhs.limbs_) >= 0) {
+        return BigInt(SubtractMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_);
+    }
+    return BigInt(SubtractMagnitude(rhs.limbs_, lhs.limbs_), rhs.negative_);
+}
+
+BigInt operator-(const BigInt& lhs, const BigInt& rhs) {
+    return lhs + -rhs;
+}
+
+BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+    return BigInt(MultiplyMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_ != rhs.negative_);
+}
+
+BigInt operator/(const BigInt& lhs, const BigInt& rhs) {
+    assert(!rhs.IsZero());
+    return BigInt(DivideMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_ != rhs.negative_);
+}
+
+int Compare(const BigInt& lhs, const BigInt& rhs) {
+    if (lhs.negative_ != rhs.negative_) {
+        return lhs.negative_ ? -1 : 1;
+    }
+    int res = CompareMagnitude(lhs.limbs_, rhs.limbs_);
+    return lhs.negative_ ? -res : res;
+}
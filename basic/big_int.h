@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary-precision integer behind the numbers that do not fit into
+// int64_t. Sign and magnitude, the magnitude in 32-bit limbs, least
+// significant first and without leading zero limbs, so zero has no limbs.
+class BigInt {
+public:
+    BigInt() = default;
+    explicit BigInt(int64_t value);
+
+    // Decimal digits with an optional sign, as the tokenizer accepts them.
+    static BigInt FromString(std::string_view text);
+
+    bool IsNegative() const;
+    bool IsZero() const;
+    bool FitsInt64() const;
+    // Only for values that fit.
+    int64_t ToInt64() const;
+    std::string ToString() const;
+
+    BigInt operator-() const;
+    BigInt Abs() const;
+
+    friend BigInt operator+(const BigInt& lhs, const BigInt& rhs);
+    friend BigInt operator-(const BigInt& lhs, const BigInt& rhs);
+    // Karatsuba once both operands are long enough, schoolbook below that.
+    friend BigInt operator*(const BigInt& lhs, const BigInt& rhs);
+    // Truncates toward zero like int64_t division. The divisor must not be
+    // zero.
+    friend BigInt operator/(const BigInt& lhs, const BigInt& rhs);
+
+    // Negative, zero or positive as lhs is less than, equal to or greater
+    // than rhs.
+    friend int Compare(const BigInt& lhs, const BigInt& rhs);
+    friend bool operator==(const BigInt& lhs, const BigInt& rhs) = default;
+
+private:
+    BigInt(std::vector<uint32_t> limbs, bool negative);
+
+    std::vector<uint32_t> limbs_;
+    bool negative_ = false;
+};
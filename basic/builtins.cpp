@@ -0,0 +1,655 @@
+#include "builtins.h"
+#include <algorithm>
+#include <limits>
+#include <parser.h>
+#include "error.h"
+#include "heap.h"
+#include "numeric_kernels.h"
+#include "parallel_eval.h"
+
+void CheckNullptr(Object* ptr) {
+    if (ptr == nullptr) {
+        throw RuntimeError("Nullptr issue");
+    }
+}
+
+template <typename T>
+void CheckIfValidTypes(Function::Args vec) {
+    for (auto elem : vec) {
+        if (!Is<T>(elem)) {
+            throw RuntimeError("Wrong Types");
+        }
+    }
+}
+
+void CheckIfBadArgsCount(Function::Args vec, std::initializer_list<size_t> bad_counts,
+                         std::initializer_list<size_t> good_counts) {
+    if (bad_counts.size() != 0) {
+        for (auto elem : bad_counts) {
+            if (vec.size() == elem) {
+                throw RuntimeError("Wrong Types");
+            }
+        }
+    } else {
+        bool fl = false;
+        for (auto elem : good_counts) {
+            if (vec.size() == elem) {
+                fl = true;
+            }
+        }
+        if (!fl) {
+            throw RuntimeError("Wrong Types");
+        }
+    }
+}
+
+void CheckIfPairs(Function::Args vec) {
+    for (auto elem : vec) {
+        if (!IsPair(elem)) {
+            throw RuntimeError("Wrong Types");
+        }
+    }
+}
+
+// Number arguments are unboxed onto the C++ stack this many at a time, so the
+// numeric kernels always see contiguous values and nothing is allocated.
+constexpr size_t kUnboxBlock = 256;
+
+// How a pass over the unboxed arguments ended.
+enum class Unboxed { kAll, kStopped, kBig };
+
+// Unboxes Number arguments block by block and calls f(values, count) on each
+// block, stopping as soon as f returns false or a big number turns up. Every
+// argument is checked to be a Number all the same, like
+// CheckIfValidTypes<Number> does. With overlap set, every block after the
+// first one starts with the last value of the block before it, so a pairwise
+// check sees each adjacent pair exactly once.
+template <typename F>
+Unboxed ForEachUnboxedBlock(Function::Args args, bool overlap, F f) {
+    int64_t block[kUnboxBlock];
+    size_t size = 0;
+    size_t i = 0;
+    while (i < args.size()) {
+        if (overlap && size > 0) {
+            block[0] = block[size - 1];
+            size = 1;
+        } else {
+            size = 0;
+        }
+        while (size < kUnboxBlock && i < args.size()) {
+            auto elem = args[i++];
+            if (!Is<Number>(elem)) {
+                throw RuntimeError("Wrong Types");
+            }
+            if (As<Number>(elem)->IsBig()) {
+                CheckIfValidTypes<Number>(args.subspan(i));
+                return Unboxed::kBig;
+            }
+            block[size++] = As<Number>(elem)->GetValue();
+        }
+        if (!f(block, size)) {
+            CheckIfValidTypes<Number>(args.subspan(i));
+            return Unboxed::kStopped;
+        }
+    }
+    return Unboxed::kAll;
+}
+
+// Negative, zero or positive as lhs is less than, equal to or greater than
+// rhs.
+int CompareNumbers(Object* lhs, Object* rhs) {
+    auto lhs_number = As<Number>(lhs);
+    auto rhs_number = As<Number>(rhs);
+    if (lhs_number->IsBig() || rhs_number->IsBig()) {
+        return Compare(lhs_number->GetBigValue(), rhs_number->GetBigValue());
+    }
+    return (lhs_number->GetValue() > rhs_number->GetValue()) -
+           (lhs_number->GetValue() < rhs_number->GetValue());
+}
+
+// A comparison builtin: true when every adjacent pair of arguments satisfies
+// the relation. The kernel checks it on unboxed values, holds on the result
+// of CompareNumbers once some argument is big.
+bool AllPairs(Function::Args args, bool (*kernel)(const int64_t*, size_t), bool (*holds)(int)) {
+    auto unboxed = ForEachUnboxedBlock(args, true, kernel);
+    if (unboxed != Unboxed::kBig) {
+        return unboxed == Unboxed::kAll;
+    }
+    for (size_t i = 0; i + 1 < args.size(); ++i) {
+        if (!holds(CompareNumbers(args[i], args[i + 1]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sum of the arguments in int64_t. Returns false if one of them is big or the
+// sum overflows.
+bool TrySumSmall(Function::Args args, int64_t* res) {
+    const auto& kernels = GetNumericKernels();
+    int64_t sum = 0;
+    auto unboxed = ForEachUnboxedBlock(args, false, [&](const int64_t* values, size_t count) {
+        int64_t block_sum;
+        return kernels.sum(values, count, &block_sum) &&
+               !__builtin_add_overflow(sum, block_sum, &sum);
+    });
+    *res = sum;
+    return unboxed == Unboxed::kAll;
+}
+
+// Sum of Number arguments of any size.
+BigInt SumBig(Function::Args args) {
+    BigInt res;
+    for (auto elem : args) {
+        res = res + As<Number>(elem)->GetBigValue();
+    }
+    return res;
+}
+
+// Folds the per-block results of kernel with combine. Returns false if one of
+// the arguments is big. There must be at least one argument.
+bool TryFoldSmall(Function::Args args, int64_t (*kernel)(const int64_t*, size_t),
+                  int64_t (*combine)(int64_t, int64_t), int64_t* res) {
+    bool first = true;
+    auto unboxed = ForEachUnboxedBlock(args, false, [&](const int64_t* values, size_t count) {
+        auto block_res = kernel(values, count);
+        *res = first ? block_res : combine(*res, block_res);
+        first = false;
+        return true;
+    });
+    return unboxed == Unboxed::kAll;
+}
+
+// A list ending in nothing rather than in an atom.
+bool IsProperList(Object* list) {
+    while (true) {
+        if (list == nullptr) {
+            return true;
+        }
+        Object* ptr_second;
+        if (Is<List>(list)) {
+            ptr_second = As<List>(list)->GetTail();
+        } else if (Is<Cell>(list)) {
+            ptr_second = As<Cell>(list)->GetSecond();
+        } else {
+            return false;
+        }
+        if (ptr_second == nullptr) {
+            return true;
+        }
+        if (Is<Number>(ptr_second)) {
+            return false;
+        }
+        list = ptr_second;
+    }
+}
+
+std::vector<Object*> ConvertToVector(Object* cell) {
+    std::vector<Object*> to_ret;
+    ForEachElement(cell, [&to_ret](Object* elem) { to_ret.push_back(elem); });
+    return to_ret;
+}
+
+bool IsPair(Object* obj) {
+    return Is<Cell>(obj) || Is<List>(obj);
+}
+
+Object* PairFirst(Object* pair) {
+    return Is<List>(pair) ? As<List>(pair)->At(0) : As<Cell>(pair)->GetFirst();
+}
+
+size_t CountElements(Object* list) {
+    size_t count = 0;
+    if (list == nullptr) {
+        return count;
+    }
+    while (true) {
+        Object* ptr_second;
+        if (Is<List>(list)) {
+            count += As<List>(list)->Size();
+            ptr_second = As<List>(list)->GetTail();
+        } else if (Is<Cell>(list)) {
+            ++count;
+            ptr_second = As<Cell>(list)->GetSecond();
+        } else {
+            throw RuntimeError("RE");
+        }
+        if (ptr_second == nullptr) {
+            return count;
+        }
+        if (Is<Number>(ptr_second)) {
+            return count + 1;
+        }
+        list = ptr_second;
+    }
+}
+
+Object* DropElements(Object* list, size_t count, Heap* heap) {
+    while (count > 0) {
+        if (Is<List>(list)) {
+            auto cur = As<List>(list);
+            if (count < cur->Size()) {
+                return cur->Suffix(count, heap);
+            }
+            count -= cur->Size();
+            list = cur->GetTail();
+        } else {
+            list = As<Cell>(list)->GetSecond();
+            --count;
+        }
+    }
+    return list;
+}
+
+// parallel-map splits its list into chunks of at least this many elements;
+// applying a builtin to one element takes too little time to be worth
+// handing over to another thread on its own.
+constexpr size_t kMapMinChunk = 256;
+
+// Checks the arguments of map and parallel-map, a function and a list, and
+// returns the function along with the elements of the list. Special forms
+// take their operands unevaluated, so they cannot be applied to elements.
+Function* GetMapArgs(Function::Args args, std::vector<Object*>* elements) {
+    CheckIfBadArgsCount(args, {}, {2});
+    if (!Is<Function>(args[0]) || As<Function>(args[0])->IsSpecialForm() || !IsPair(args[1])) {
+        throw RuntimeError("Wrong Types");
+    }
+    auto list = PairFirst(args[1]);
+    if (!IsProperList(list)) {
+        throw RuntimeError("Wrong Types");
+    }
+    *elements = ConvertToVector(list);
+    return As<Function>(args[0]);
+}
+
+Builtins::Builtins(SymbolTable* symbols) : symbols_(symbols) {
+    RegisterSpecialForm("quote", [](Context*, Function::Args) -> Object* {
+        return nullptr;
+    });
+    /*NUMBER FUNCTIONS*/
+    Register("number?", [](Context*, Function::Args args) {
+        CheckIfBadArgsCount(args, {0}, {});
+        Object* to_ret;
+        to_ret = MakeBool(Is<Number>(args.front()));
+        return to_ret;
+    });
+    Register("=", [](Context*, Function::Args args) {
+        Object* to_ret;
+        bool res = AllPairs(args, GetNumericKernels().equal, [](int cmp) { return cmp == 0; });
+        to_ret = MakeBool(res);
+        return to_ret;
+    });
+    Register(">", [](Context*, Function::Args args) {
+        Object* to_ret;
+        bool res = AllPairs(args, GetNumericKernels().greater, [](int cmp) { return cmp > 0; });
+        to_ret = MakeBool(res);
+        return to_ret;
+    });
+    Register("<", [](Context*, Function::Args args) {
+        Object* to_ret;
+        bool res = AllPairs(args, GetNumericKernels().less, [](int cmp) { return cmp < 0; });
+        to_ret = MakeBool(res);
+        return to_ret;
+    });
+    Register("<=", [](Context*, Function::Args args) {
+        Object* to_ret;
+        bool res = AllPairs(args, GetNumericKernels().less_equal, [](int cmp) { return cmp <= 0; });
+        to_ret = MakeBool(res);
+        return to_ret;
+    });
+    Register(">=", [](Context*, Function::Args args) {
+        Object* to_ret;
+        bool res =
+            AllPairs(args, GetNumericKernels().greater_equal, [](int cmp) { return cmp >= 0; });
+        to_ret = MakeBool(res);
+        return to_ret;
+    });
+    Register("+", [](Context* context, Function::Args args) {
+        Object* to_ret;
+        int64_t res;
+        if (TrySumSmall(args, &res)) {
+            to_ret = MakeNumber(context->heap, res);
+        } else {
+            to_ret = MakeNumber(context->heap, SumBig(args));
+        }
+        return to_ret;
+    });
+    Register("*", [](Context* context, Function::Args args) {
+        CheckIfValidTypes<Number>(args);
+        Object* to_ret;
+        // In int64_t until an argument is big or a product overflows, and in
+        // BigInt from there on.
+        int64_t res = 1;
+        size_t i = 0;
+        for (; i < args.size(); ++i) {
+            auto number = As<Number>(args[i]);
+            int64_t product;
+            if (number->IsBig() || __builtin_mul_overflow(res, number->GetValue(), &product)) {
+                break;
+            }
+            res = product;
+        }
+        if (i == args.size()) {
+            to_ret = MakeNumber(context->heap, res);
+            return to_ret;
+        }
+        BigInt big_res(res);
+        for (; i < args.size(); ++i) {
+            big_res = big_res * As<Number>(args[i])->GetBigValue();
+        }
+        to_ret = MakeNumber(context->heap, std::move(big_res));
+        return to_ret;
+    });
+    Register("-", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {0}, {});
+        CheckIfValidTypes<Number>(args.first(1));
+        Object* to_ret;
+        // Subtracting the rest one by one is subtracting their sum.
+        auto first = As<Number>(args[0]);
+        auto rest = args.subspan(1);
+        int64_t rest_sum;
+        int64_t res;
+        if (TrySumSmall(rest, &rest_sum) && !first->IsBig() &&
+            !__builtin_sub_overflow(first->GetValue(), rest_sum, &res)) {
+            to_ret = MakeNumber(context->heap, res);
+        } else {
+            to_ret = MakeNumber(context->heap, first->GetBigValue() - SumBig(rest));
+        }
+        return to_ret;
+    });
+    Register("/", [](Context* context, Function::Args args) {
+        CheckIfValidTypes<Number>(args);
+        CheckIfBadArgsCount(args, {0}, {});
+        Object* to_ret;
+        auto first = As<Number>(args[0]);
+        int64_t res = 0;
+        size_t i = 1;
+        if (!first->IsBig()) {
+            res = first->GetValue();
+            for (; i < args.size(); ++i) {
+                auto number = As<Number>(args[i]);
+                if (number->IsBig()) {
+                    break;
+                }
+                if (number->GetValue() == 0) {
+                    throw RuntimeError("Division by zero");
+                }
+                // The one quotient that does not fit.
+                if (res == std::numeric_limits<int64_t>::min() && number->GetValue() == -1) {
+                    break;
+                }
+                res /= number->GetValue();
+            }
+            if (i == args.size()) {
+                to_ret = MakeNumber(context->heap, res);
+                return to_ret;
+            }
+        }
+        BigInt big_res = first->IsBig() ? first->GetBigValue() : BigInt(res);
+        for (; i < args.size(); ++i) {
+            auto divisor = As<Number>(args[i])->GetBigValue();
+            if (divisor.IsZero()) {
+                throw RuntimeError("Division by zero");
+            }
+            big_res = big_res / divisor;
+        }
+        to_ret = MakeNumber(context->heap, std::move(big_res));
+        return to_ret;
+    });
+    Register("max", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {0}, {});
+        Object* to_ret;
+        int64_t res;
+        if (TryFoldSmall(args, GetNumericKernels().max,
+                         [](int64_t lhs, int64_t rhs) { return std::max(lhs, rhs); }, &res)) {
+            to_ret = MakeNumber(context->heap, res);
+        } else {
+            to_ret = args[0];
+            for (auto elem : args) {
+                if (CompareNumbers(elem, to_ret) > 0) {
+                    to_ret = elem;
+                }
+            }
+        }
+        return to_ret;
+    });
+    Register("min", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {0}, {});
+        Object* to_ret;
+        int64_t res;
+        if (TryFoldSmall(args, GetNumericKernels().min,
+                         [](int64_t lhs, int64_t rhs) { return std::min(lhs, rhs); }, &res)) {
+            to_ret = MakeNumber(context->heap, res);
+        } else {
+            to_ret = args[0];
+            for (auto elem : args) {
+                if (CompareNumbers(elem, to_ret) < 0) {
+                    to_ret = elem;
+                }
+            }
+        }
+        return to_ret;
+    });
+    Register("abs", [](Context* context, Function::Args args) {
+        CheckIfValidTypes<Number>(args);
+        CheckIfBadArgsCount(args, {}, {1});
+        Object* to_ret;
+        auto number = As<Number>(args.front());
+        if (number->IsBig() || number->GetValue() == std::numeric_limits<int64_t>::min()) {
+            to_ret = MakeNumber(context->heap, number->GetBigValue().Abs());
+        } else {
+            to_ret = MakeNumber(context->heap, std::abs(number->GetValue()));
+        }
+        return to_ret;
+    });
+    /*BOOLEAN FUNCTIONS*/
+    Register("boolean?", [](Context*, Function::Args args) {
+        CheckIfBadArgsCount(args, {0}, {});
+        Object* to_ret;
+        to_ret = MakeBool(Is<Bool>(args.front()));
+        return to_ret;
+    });
+    Register("not", [](Context*, Function::Args args) {
+        CheckIfBadArgsCount(args, {}, {1});
+        Object* to_ret;
+        bool value = false;
+        if (Is<Bool>(args.front())) {
+            value = !As<Bool>(args.front())->GetBool();
+        }
+        to_ret = MakeBool(value);
+        return to_ret;
+    });
+    RegisterSpecialForm("and", [](Context* context, Function::Args args) {
+        Object* to_ret = MakeBool(true);
+        for (auto elem : args) {
+            CheckNullptr(elem);
+            auto evaluated = elem->Eval(context);
+            if (Is<Bool>(evaluated) && !As<Bool>(evaluated)->GetBool()) {
+                to_ret = evaluated;
+                break;
+            }
+            to_ret = evaluated;
+        }
+        return to_ret;
+    });
+    RegisterSpecialForm("or", [](Context* context, Function::Args args) {
+        Object* to_ret = MakeBool(false);
+        for (auto elem : args) {
+            CheckNullptr(elem);
+            auto evaluated = elem->Eval(context);
+            if (Is<Bool>(evaluated) && !As<Bool>(evaluated)->GetBool()) {
+            } else {
+                to_ret = evaluated;
+                break;
+            }
+        }
+        return to_ret;
+    });
+    /*LIST OPERATIONS*/
+    Register("pair?", [](Context*, Function::Args args) -> Object* {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        return MakeBool(CountElements(PairFirst(args.front())) == 2);
+    });
+    Register("null?", [](Context*, Function::Args args) -> Object* {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        auto pair = args.front();
+        bool res;
+        if (Is<List>(pair)) {
+            res = As<List>(pair)->Size() == 1 && As<List>(pair)->At(0) == nullptr &&
+                  As<List>(pair)->GetTail() == nullptr;
+        } else {
+            res = As<Cell>(pair)->GetFirst() == nullptr && As<Cell>(pair)->GetSecond() == nullptr;
+        }
+        return MakeBool(res);
+    });
+    Register("list?", [](Context*, Function::Args args) -> Object* {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        return MakeBool(IsProperList(PairFirst(args.front())));
+    });
+    Register("length", [](Context* context, Function::Args args) -> Object* {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        auto list = PairFirst(args.front());
+        if (!IsProperList(list)) {
+            throw RuntimeError("Wrong Types");
+        }
+        return MakeNumber(context->heap, CountElements(list));
+    });
+    RegisterSpecialForm("cons", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {}, {2});
+        auto dot = context->heap->Make<Dot>();
+        return ListASTFromVector({args[0], dot, args[1]}, context->heap);
+    });
+    Register("car", [](Context*, Function::Args args) {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        auto list = PairFirst(args.front());
+        if (CountElements(list) == 0) {
+            throw RuntimeError("Wrong Types");
+        }
+        return PairFirst(list);
+    });
+    Register("cdr", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {}, {1});
+        CheckIfPairs(args);
+        Object* to_ret;
+        auto list = PairFirst(args.front());
+        auto count = CountElements(list);
+        if (count == 0) {
+            throw RuntimeError("Wrong Types");
+        }
+        if (count == 1) {
+            to_ret = context->heap->Make<Cell>();
+            return to_ret;
+        }
+        auto temp = DropElements(list, 1, context->heap);
+        if (Is<Number>(temp)) {
+            return temp;
+        }
+        to_ret = context->heap->Make<Cell>();
+        As<Cell>(to_ret)->GetFirst() = temp;
+        return to_ret;
+    });
+    RegisterSpecialForm("list", [](Context* context, Function::Args args) {
+        return MakeList({args.begin(), args.end()}, context->heap);
+    });
+    Register("list-ref", [](Context* context, Function::Args args) {
+        CheckIfBadArgsCount(args, {}, {2});
+        if (!IsPair(args.front()) || !Is<Number>(args.back())) {
+            throw RuntimeError("Wrong types");
+        }
+        if (As<Number>(args.back())->IsBig()) {
+            throw RuntimeError("Index error");
+        }
+        int64_t ind = As<Number>(args.back())->GetValue();
+        if (ind < 0) {
+            throw RuntimeError("Index error");
+        }
+        auto index = static_cast<size_t>(ind);
+        auto list = PairFirst(args.front());
+        if (index >= CountElements(list)) {
+            throw RuntimeError("Index error");
+        }
+        auto rest = DropElements(list, index, context->heap);
+        return IsPair(rest) ? PairFirst(rest) : rest;
+    });
+    Register("list-tail", [](Context* context, Function::Args args) {
+        Object* to_ret;
+        CheckIfBadArgsCount(args, {}, {2});
+        if (!IsPair(args.front()) || !Is<Number>(args.back())) {
+            throw RuntimeError("Wrong types");
+        }
+        if (As<Number>(args.back())->IsBig()) {
+            throw RuntimeError("Index error");
+        }
+        int64_t ind = As<Number>(args.back())->GetValue();
+        if (ind < 0) {
+            throw RuntimeError("Index error");
+        }
+        auto index = static_cast<size_t>(ind);
+        auto list = PairFirst(args.front());
+        auto count = CountElements(list);
+        if (index > count) {
+            throw RuntimeError("Index error");
+        }
+        if (index == count) {
+            to_ret = context->heap->Make<Cell>();
+            return to_ret;
+        }
+        return DropElements(list, index, context->heap);
+    });
+    Register("map", [](Context* context, Function::Args args) {
+        std::vector<Object*> elements;
+        auto function = GetMapArgs(args, &elements);
+        for (auto& elem : elements) {
+            elem = function->Apply(context, Function::Args(&elem, 1));
+        }
+        return MakeList(std::move(elements), context->heap);
+    });
+    // Same as map, but applies the function on several threads. Errors are
+    // raised as map would raise them, for the leftmost failing element.
+    Register("parallel-map", [](Context* context, Function::Args args) {
+        std::vector<Object*> elements;
+        auto function = GetMapArgs(args, &elements);
+        std::vector<Object*> results(elements.size());
+        ParallelEval(context, results, kMapMinChunk, [&](size_t i, Context* context) {
+            return function->Apply(context, Function::Args(&elements[i], 1));
+        });
+        return MakeList(std::move(results), context->heap);
+    });
+}
+
+void Builtins::Register(std::string_view name, Function::Impl impl) {
+    Add(name, impl, false);
+}
+
+void Builtins::RegisterSpecialForm(std::string_view name, Function::Impl impl) {
+    Add(name, impl, true);
+}
+
+void Builtins::Add(std::string_view name, Function::Impl impl, bool special_form) {
+    size_t id = symbols_->Intern(name)->GetId();
+    if (functions_.size() <= id) {
+        functions_.resize(id + 1);
+    }
+    functions_[id] = std::make_unique<Function>(std::string(name), id, impl, special_form);
+}
+
+Function* Builtins::Find(const Symbol& symbol) const {
+    auto function = TryFind(symbol);
+    if (function == nullptr) {
+        throw RuntimeError("Unknown Function");
+    }
+    return function;
+}
+
+Function* Builtins::TryFind(const Symbol& symbol) const {
+    size_t id = symbol.GetId();
+    if (id >= functions_.size()) {
+        return nullptr;
+    }
+    return functions_[id].get();
+}
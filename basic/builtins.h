@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "context.h"
+#include "error.h"
+#include "object.h"
+#include "symbol_table.h"
+
+// Registry of the builtin functions, filled once per GlobalEnvironment and
+// then only read, by every session on it at once.
+// Functions are indexed by symbol id, so resolving a symbol is a single
+// index lookup and never allocates.
+class Builtins {
+public:
+    explicit Builtins(SymbolTable* symbols);
+
+    void Register(std::string_view name, Function::Impl impl);
+    void RegisterSpecialForm(std::string_view name, Function::Impl impl);
+
+    // Find throws RuntimeError for a symbol that names no builtin, TryFind
+    // returns nullptr.
+    Function* Find(const Symbol& symbol) const;
+    Function* TryFind(const Symbol& symbol) const;
+
+private:
+    void Add(std::string_view name, Function::Impl impl, bool special_form);
+
+    SymbolTable* symbols_;
+    std::vector<std::unique_ptr<Function>> functions_;
+};
+
+void CheckNullptr(Object* ptr);
+
+// Calls f on every element of a list in order: the elements of its Cells
+// and Lists, then a number ending it. Any other tail is a RuntimeError,
+// raised once the elements before it were visited.
+template <class F>
+void ForEachElement(Object* list, F f) {
+    if (list == nullptr) {
+        return;
+    }
+    while (true) {
+        Object* ptr_second;
+        if (Is<List>(list)) {
+            auto cur = As<List>(list);
+            for (size_t i = 0; i < cur->Size(); ++i) {
+                f(cur->At(i));
+            }
+            ptr_second = cur->GetTail();
+        } else if (Is<Cell>(list)) {
+            f(As<Cell>(list)->GetFirst());
+            ptr_second = As<Cell>(list)->GetSecond();
+        } else {
+            throw RuntimeError("RE");
+        }
+        if (ptr_second == nullptr) {
+            return;
+        }
+        if (Is<Number>(ptr_second)) {
+            f(ptr_second);
+            return;
+        }
+        list = ptr_second;
+    }
+}
+
+std::vector<Object*> ConvertToVector(Object* cell);
+
+// Cells and Lists are both pairs to the list builtins.
+bool IsPair(Object* obj);
+Object* PairFirst(Object* pair);
+
+// What ConvertToVector(list).size() would be, without building the vector.
+size_t CountElements(Object* list);
+
+// The list with its first count elements dropped, as count cdrs would leave
+// it; count must not exceed CountElements(list).
+Object* DropElements(Object* list, size_t count, Heap* heap);
+
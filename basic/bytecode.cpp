@@ -0,0 +1,168 @@
+#include "bytecode.h"
+#include "error.h"
+#include "parser.h"
+
+namespace {
+
+class Compiler {
+public:
+    Compiler(const Builtins& builtins, Program* program) : builtins_(builtins), program_(program) {
+    }
+
+    void CompileExpr(Object* expr) {
+        if (expr == nullptr) {
+            EmitThrow("Nullptr issue");
+        } else if (Is<Cell>(expr)) {
+            CompileCall(As<Cell>(expr));
+        } else if (Is<Symbol>(expr)) {
+            auto function = builtins_.TryFind(*As<Symbol>(expr));
+            if (function == nullptr) {
+                EmitThrow("Unknown Function");
+            } else {
+                EmitPush(function);
+            }
+        } else if (Is<Dot>(expr)) {
+            EmitThrow("Weird, bro!");
+        } else {
+            EmitPush(expr);
+        }
+    }
+
+private:
+    void CompileCall(Cell* cell) {
+        if (!Is<Symbol>(cell->GetFirst())) {
+            EmitThrow("Wrong Function");
+            return;
+        }
+        auto symbol = As<Symbol>(cell->GetFirst());
+        auto function = builtins_.TryFind(*symbol);
+        if (function == nullptr) {
+            EmitThrow("Unknown Function");
+            return;
+        }
+        if (symbol->GetId() == SymbolTable::kQuote) {
+            EmitPush(cell->GetSecond());
+            return;
+        }
+
+        std::vector<Object*> args;
+        try {
+            args = ConvertToVector(cell->GetSecond());
+        } catch (const RuntimeError& error) {
+            EmitThrow(error.what());
+            return;
+        }
+
+        if (function->GetName() == "and") {
+            CompileShortCircuit(args, OpCode::kJumpIfFalse, true);
+        } else if (function->GetName() == "or") {
+            CompileShortCircuit(args, OpCode::kJumpIfTrue, false);
+        } else if (function->IsSpecialForm()) {
+            Emit(OpCode::kCallSpecial, AddFunction(function), program_->forms.size());
+            program_->forms.push_back(std::move(args));
+        } else {
+            for (auto arg : args) {
+                CompileExpr(arg);
+            }
+            Emit(OpCode::kCall, AddFunction(function), args.size());
+        }
+    }
+
+    // and/or: every argument but the last one either decides the result and
+    // jumps to the end, or is popped before the next one is evaluated.
+    void CompileShortCircuit(const std::vector<Object*>& args, OpCode jump, bool empty_result) {
+        if (args.empty()) {
+            EmitPush(MakeBool(empty_result));
+            return;
+        }
+        std::vector<size_t> jumps;
+        for (size_t i = 0; i < args.size(); ++i) {
+            CompileExpr(args[i]);
+            if (i + 1 < args.size()) {
+                jumps.push_back(program_->code.size());
+                Emit(jump);
+                Emit(OpCode::kPop);
+            }
+        }
+        for (auto pos : jumps) {
+            program_->code[pos].a = program_->code.size();
+        }
+    }
+
+    uint32_t AddFunction(Function* function) {
+        program_->functions.push_back(function);
+        return program_->functions.size() - 1;
+    }
+
+    void EmitPush(Object* value) {
+        Emit(OpCode::kPush, program_->constants.size());
+        program_->constants.push_back(value);
+    }
+
+    void EmitThrow(std::string message) {
+        Emit(OpCode::kThrow, program_->errors.size());
+        program_->errors.push_back(std::move(message));
+    }
+
+    void Emit(OpCode op, uint32_t a = 0, uint32_t b = 0) {
+        program_->code.push_back(Instruction{op, a, b});
+    }
+
+    const Builtins& builtins_;
+    Program* program_;
+};
+
+bool IsFalse(Object* value) {
+    return Is<Bool>(value) && !As<Bool>(value)->GetBool();
+}
+
+}  // namespace
+
+Program Compile(Object* ast, const Builtins& builtins) {
+    Program program;
+    Compiler(builtins, &program).CompileExpr(ast);
+    return program;
+}
+
+Object* Execute(const Program& program, Context* context) {
+    std::vector<Object*> stack;
+    const auto& code = program.code;
+    for (size_t pc = 0; pc < code.size();) {
+        const auto& instruction = code[pc++];
+        switch (instruction.op) {
+            case OpCode::kPush:
+                stack.push_back(program.constants[instruction.a]);
+                break;
+            case OpCode::kCall: {
+                // Procedures never evaluate anything, so the stack cannot
+                // change under the arguments while the call runs.
+                auto first = stack.size() - instruction.b;
+                auto result = program.functions[instruction.a]->Apply(
+                    context, Function::Args(stack.data() + first, instruction.b));
+                stack.resize(first);
+                stack.push_back(result);
+                break;
+            }
+            case OpCode::kCallSpecial:
+                stack.push_back(program.functions[instruction.a]->Apply(
+                    context, program.forms[instruction.b]));
+                break;
+            case OpCode::kJumpIfFalse:
+                if (IsFalse(stack.back())) {
+                    pc = instruction.a;
+                }
+                break;
+            case OpCode::kJumpIfTrue:
+                if (!IsFalse(stack.back())) {
+                    pc = instruction.a;
+                }
+                break;
+            case OpCode::kPop:
+                stack.pop_back();
+                break;
+            case OpCode::kThrow:
+                throw RuntimeError(program.errors[instruction.a]);
+        }
+    }
+    return stack.back();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "builtins.h"
+#include "context.h"
+#include "object.h"
+
+enum class OpCode : uint8_t {
+    // Push constants[a].
+    kPush,
+    // Pop b values and push the result of applying functions[a] to them.
+    kCall,
+    // Push the result of applying the special form functions[a] to the
+    // unevaluated arguments forms[b].
+    kCallSpecial,
+    // Jump to a if the top of the stack is #f (resp. is not #f), leaving the
+    // value on the stack either way.
+    kJumpIfFalse,
+    kJumpIfTrue,
+    kPop,
+    // Throw RuntimeError(errors[a]). Errors the tree walker would only hit
+    // while evaluating are compiled into this, so they still fire only if
+    // the faulty subexpression is actually reached.
+    kThrow,
+};
+
+struct Instruction {
+    OpCode op;
+    uint32_t a = 0;
+    uint32_t b = 0;
+};
+
+// Flat code for one expression. Constants and forms point into the AST the
+// program was compiled from, so that AST has to outlive the program.
+struct Program {
+    std::vector<Instruction> code;
+    std::vector<Object*> constants;
+    std::vector<Function*> functions;
+    std::vector<std::vector<Object*>> forms;
+    std::vector<std::string> errors;
+};
+
+Program Compile(Object* ast, const Builtins& builtins);
+
+// Runs the program on a value stack and returns what the tree walker would
+// have returned for the same AST.
+Object* Execute(const Program& program, Context* context);
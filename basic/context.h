@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+class ArgumentStack;
+class Builtins;
+class CallCounters;
+class Heap;
+class LineIndex;
+class SamplingProfiler;
+class WorkStealingPool;
+
+// State shared by all Eval calls of one Interpreter.
+struct Context {
+    const Builtins* builtins;
+    Heap* heap;
+    ArgumentStack* arguments;
+
+    // Where parallel-map and parallel argument evaluation run. With no pool,
+    // shared_pool sends them to WorkStealingPool::Shared(), which is only
+    // looked up, and so started, once there is work to split; otherwise they
+    // stay on the calling thread.
+    WorkStealingPool* pool = nullptr;
+    bool shared_pool = false;
+    // Calls with at least this many arguments evaluate them concurrently;
+    // 0 never does.
+    size_t parallel_min_args = 0;
+
+    // Where builtin calls are counted; nullptr when instrumentation is off.
+    CallCounters* calls = nullptr;
+    // Samples the calls being evaluated; nullptr when profiling is off.
+    SamplingProfiler* profiler = nullptr;
+
+    // Positions in the text the AST being evaluated was read from, which
+    // its source offsets point into; nullptr if unknown.
+    LineIndex* source = nullptr;
+};
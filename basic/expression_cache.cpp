@@ -0,0 +1,73 @@
+#include "expression_cache.h"
+
+ExpressionCache::ExpressionCache(Heap* heap, size_t capacity, size_t max_source_size)
+    : heap_(heap), capacity_(capacity), max_source_size_(max_source_size) {
+}
+
+ExpressionCache::~ExpressionCache() {
+    Clear();
+}
+
+ExpressionCache::Entry* ExpressionCache::Find(std::string_view source) {
+    if (!Accepts(source)) {
+        return nullptr;
+    }
+    auto it = index_.find(source);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    nodes_.splice(nodes_.begin(), nodes_, it->second);
+    return &it->second->entry;
+}
+
+ExpressionCache::Entry* ExpressionCache::Insert(std::string_view source, Object* ast) {
+    if (!Accepts(source)) {
+        return nullptr;
+    }
+    if (nodes_.size() == capacity_) {
+        EvictLast();
+    }
+    nodes_.push_front(Node{std::string(source), Entry{ast, std::nullopt}});
+    index_.emplace(nodes_.front().source, nodes_.begin());
+    heap_->AddRoot(&nodes_.front().entry.ast);
+    stats_.size = nodes_.size();
+    return &nodes_.front().entry;
+}
+
+void ExpressionCache::Clear() {
+    while (!nodes_.empty()) {
+        heap_->RemoveRoot(&nodes_.back().entry.ast);
+        index_.erase(nodes_.back().source);
+        nodes_.pop_back();
+    }
+    stats_.size = 0;
+}
+
+void ExpressionCache::SetCapacity(size_t capacity) {
+    capacity_ = capacity;
+    while (nodes_.size() > capacity_) {
+        EvictLast();
+    }
+}
+
+bool ExpressionCache::Accepts(std::string_view source) const {
+    return capacity_ != 0 && source.size() <= max_source_size_;
+}
+
+size_t ExpressionCache::GetCapacity() const {
+    return capacity_;
+}
+
+const ExpressionCacheStats& ExpressionCache::GetStats() const {
+    return stats_;
+}
+
+void ExpressionCache::EvictLast() {
+    heap_->RemoveRoot(&nodes_.back().entry.ast);
+    index_.erase(nodes_.back().source);
+    nodes_.pop_back();
+    ++stats_.evictions;
+    stats_.size = nodes_.size();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "bytecode.h"
+#include "heap.h"
+#include "object.h"
+
+struct ExpressionCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t size = 0;
+};
+
+// Least-recently-used map from request text to its parsed AST and, once the
+// bytecode VM has run it, the compiled program. Cached ASTs live on the heap
+// and stay rooted until they are evicted. Only requests of up to a given size
+// are cached, which bounds the text held to capacity times that size.
+class ExpressionCache {
+public:
+    struct Entry {
+        Object* ast = nullptr;
+        std::optional<Program> program;
+    };
+
+    // A capacity of 0 turns the cache off: Find always misses and Insert
+    // stores nothing.
+    ExpressionCache(Heap* heap, size_t capacity, size_t max_source_size);
+    ~ExpressionCache();
+
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+    // Marks a hit entry as the most recently used one. The returned pointer
+    // stays valid until the next Insert, Clear or SetCapacity.
+    // Find and Insert do nothing for a source the cache does not accept.
+    Entry* Find(std::string_view source);
+    Entry* Insert(std::string_view source, Object* ast);
+
+    // Whether the cache is on and the source is short enough.
+    bool Accepts(std::string_view source) const;
+
+    void Clear();
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const;
+
+    const ExpressionCacheStats& GetStats() const;
+
+private:
+    struct Node {
+        std::string source;
+        Entry entry;
+    };
+
+    void EvictLast();
+
+    Heap* heap_;
+    size_t capacity_;
+    size_t max_source_size_;
+    ExpressionCacheStats stats_;
+    // Most recently used first. Keys view the source stored in the node.
+    std::list<Node> nodes_;
+    std::unordered_map<std::string_view, std::list<Node>::iterator> index_;
+};
@@ -0,0 +1,16 @@
+#include "global_environment.h"
+
+GlobalEnvironment::GlobalEnvironment() = default;
+
+std::shared_ptr<const GlobalEnvironment> GlobalEnvironment::GetDefault() {
+    static auto environment = std::make_shared<const GlobalEnvironment>();
+    return environment;
+}
+
+const SymbolTable& GlobalEnvironment::GetSymbols() const {
+    return symbols_;
+}
+
+const Builtins& GlobalEnvironment::GetBuiltins() const {
+    return builtins_;
+}
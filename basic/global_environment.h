@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "builtins.h"
+#include "symbol_table.h"
+
+// What every Interpreter evaluates against: the builtins and the symbols
+// naming them. Nothing changes it after construction, so any number of
+// Interpreters on any threads can share one and read it without locking.
+class GlobalEnvironment {
+public:
+    GlobalEnvironment();
+
+    GlobalEnvironment(const GlobalEnvironment&) = delete;
+    GlobalEnvironment& operator=(const GlobalEnvironment&) = delete;
+
+    // One environment for the whole process, built on first use. Interpreters
+    // made without an environment share it.
+    static std::shared_ptr<const GlobalEnvironment> GetDefault();
+
+    // Sessions extend this table with the names they read.
+    const SymbolTable& GetSymbols() const;
+    const Builtins& GetBuiltins() const;
+
+private:
+    SymbolTable symbols_;
+    Builtins builtins_{&symbols_};
+};
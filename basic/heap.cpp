@@ -0,0 +1,166 @@
+#include "heap.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// What Make allocated for an object, which is all it takes to know its type.
+// Objects do not store their size, so that the word holding the collector's
+// flags has room for a source offset.
+size_t SizeOf(ObjectType type) {
+    switch (type) {
+        case ObjectType::kNumber:
+            return sizeof(Number);
+        case ObjectType::kSymbol:
+            return sizeof(Symbol);
+        case ObjectType::kFunction:
+            return sizeof(Function);
+        case ObjectType::kBool:
+            return sizeof(Bool);
+        case ObjectType::kDot:
+            return sizeof(Dot);
+        case ObjectType::kCell:
+            return sizeof(Cell);
+        case ObjectType::kList:
+            return sizeof(List);
+    }
+    return 0;
+}
+
+}  // namespace
+
+Heap::Heap(HeapOptions options) : options_(options) {
+}
+
+Heap::~Heap() {
+    while (objects_) {
+        Object* next = objects_->gc_next_;
+        delete objects_;
+        objects_ = next;
+    }
+}
+
+void Heap::Track(Object* obj, size_t size) {
+    assert(size == SizeOf(obj->GetType()));
+    obj->gc_next_ = objects_;
+    obj->gc_tracked_ = true;
+    objects_ = obj;
+
+    ++stats_.objects_live;
+    ++stats_.objects_made[static_cast<size_t>(obj->GetType())];
+    stats_.bytes_live += size;
+    stats_.bytes_allocated += size;
+    allocated_since_collect_ += size;
+}
+
+void Heap::Adopt(Heap* other) {
+    if (!other->objects_) {
+        return;
+    }
+    Object* last = other->objects_;
+    while (last->gc_next_) {
+        last = last->gc_next_;
+    }
+    last->gc_next_ = objects_;
+    objects_ = std::exchange(other->objects_, nullptr);
+
+    stats_.objects_live += std::exchange(other->stats_.objects_live, 0);
+    stats_.bytes_live += std::exchange(other->stats_.bytes_live, 0);
+    stats_.bytes_allocated += other->stats_.bytes_allocated;
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        stats_.objects_made[i] += other->stats_.objects_made[i];
+        stats_.arena_objects_made[i] += other->stats_.arena_objects_made[i];
+    }
+    allocated_since_collect_ += std::exchange(other->allocated_since_collect_, 0);
+}
+
+void Heap::AddRoot(Object** root) {
+    roots_.push_back(root);
+}
+
+void Heap::RemoveRoot(Object** root) {
+    auto it = std::find(roots_.rbegin(), roots_.rend(), root);
+    if (it != roots_.rend()) {
+        roots_.erase(std::next(it).base());
+    }
+}
+
+void Heap::MaybeCollect() {
+    auto threshold = std::max<size_t>(
+        options_.min_collect_bytes,
+        static_cast<size_t>(options_.growth_factor * (stats_.bytes_live - allocated_since_collect_)));
+    if (allocated_since_collect_ >= threshold) {
+        Collect();
+    }
+}
+
+void Heap::Collect() {
+    auto start = std::chrono::steady_clock::now();
+    Mark();
+    Sweep();
+    auto pause = std::chrono::steady_clock::now() - start;
+
+    ++stats_.collections;
+    stats_.total_pause += pause;
+    stats_.max_pause = std::max<std::chrono::nanoseconds>(stats_.max_pause, pause);
+    allocated_since_collect_ = 0;
+}
+
+// Uses an explicit stack, so long and deeply nested lists cannot overflow
+// the native one.
+void Heap::Mark() {
+    std::vector<Object*> stack;
+    for (auto root : roots_) {
+        stack.push_back(*root);
+    }
+    while (!stack.empty()) {
+        Object* obj = stack.back();
+        stack.pop_back();
+        if (!obj || !obj->gc_tracked_ || obj->gc_marked_) {
+            continue;
+        }
+        obj->gc_marked_ = true;
+        if (Is<Cell>(obj)) {
+            stack.push_back(As<Cell>(obj)->GetFirst());
+            stack.push_back(As<Cell>(obj)->GetSecond());
+        } else if (Is<List>(obj)) {
+            // A suffix only has to keep its base alive, which holds the rest.
+            auto list = As<List>(obj);
+            if (list->GetBase() != list) {
+                stack.push_back(list->GetBase());
+                continue;
+            }
+            stack.push_back(list->GetTail());
+            for (size_t i = 0; i < list->Size(); ++i) {
+                stack.push_back(list->At(i));
+            }
+        }
+    }
+}
+
+void Heap::Sweep() {
+    Object** link = &objects_;
+    while (*link) {
+        Object* obj = *link;
+        if (obj->gc_marked_) {
+            obj->gc_marked_ = false;
+            link = &obj->gc_next_;
+            continue;
+        }
+        *link = obj->gc_next_;
+        --stats_.objects_live;
+        auto size = SizeOf(obj->GetType());
+        stats_.bytes_live -= size;
+        stats_.bytes_freed += size;
+        delete obj;
+    }
+}
+
+void Heap::CountArenaObject(ObjectType type) {
+    ++stats_.arena_objects_made[static_cast<size_t>(type)];
+}
+
+const HeapStats& Heap::GetStats() const {
+    return stats_;
+}
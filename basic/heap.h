@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "object.h"
+
+struct HeapOptions {
+    // A collection becomes due once at least this many bytes were allocated
+    // since the previous one...
+    size_t min_collect_bytes = 1 << 20;
+    // ...and the heap grew by this fraction of what survived it.
+    double growth_factor = 1.0;
+};
+
+struct HeapStats {
+    size_t collections = 0;
+    size_t objects_live = 0;
+    size_t bytes_live = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_freed = 0;
+    // Objects made so far, indexed by ObjectType.
+    std::array<size_t, kObjectTypeCount> objects_made{};
+    // Objects read into a request's arena instead, see CountArenaObject. They
+    // are in none of the other counts.
+    std::array<size_t, kObjectTypeCount> arena_objects_made{};
+    std::chrono::nanoseconds total_pause{0};
+    std::chrono::nanoseconds max_pause{0};
+};
+
+// Owns every object made through it and frees the unreachable ones with a
+// mark-and-sweep pass. Only objects made by Make are traced and freed;
+// interned symbols, builtins, preallocated numbers and arena nodes are
+// owned elsewhere and treated as leaves.
+class Heap {
+public:
+    explicit Heap(HeapOptions options = {});
+    ~Heap();
+
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    template <class T, class... Args>
+    T* Make(Args&&... args) {
+        T* obj = new T(std::forward<Args>(args)...);
+        Track(obj, sizeof(T));
+        return obj;
+    }
+
+    // The object stored in a registered slot at collection time is live,
+    // together with everything reachable from it.
+    void AddRoot(Object** root);
+    void RemoveRoot(Object** root);
+
+    // Collections never happen behind the caller's back: they run only from
+    // these calls, which must be made where every live object is reachable
+    // from a root, i.e. not while an evaluation is in progress.
+    void MaybeCollect();
+    void Collect();
+
+    // Takes over every object other owns, e.g. the ones an evaluation on
+    // another thread made there, and leaves other empty. Neither heap may be
+    // in use by another thread meanwhile.
+    void Adopt(Heap* other);
+
+    // Notes an object made in an arena where this heap would otherwise have
+    // made it. The object is not tracked.
+    void CountArenaObject(ObjectType type);
+
+    const HeapStats& GetStats() const;
+
+private:
+    void Track(Object* obj, size_t size);
+    void Mark();
+    void Sweep();
+
+    HeapOptions options_;
+    HeapStats stats_;
+    Object* objects_ = nullptr;
+    size_t allocated_since_collect_ = 0;
+    std::vector<Object**> roots_;
+};
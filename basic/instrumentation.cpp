@@ -0,0 +1,134 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+
+namespace {
+
+// Indexed by ObjectType.
+constexpr const char* kTypeNames[kObjectTypeCount] = {"number", "symbol", "function", "bool",
+                                                      "dot",    "cell",   "list"};
+
+std::string FormatSeconds(std::chrono::nanoseconds time) {
+    char buffer[32];
+    auto end = std::to_chars(std::begin(buffer), std::end(buffer),
+                             std::chrono::duration<double>(time).count())
+                   .ptr;
+    return std::string(buffer, end);
+}
+
+}  // namespace
+
+std::chrono::microseconds GetLatencyBucketBound(size_t bucket) {
+    if (bucket + 1 >= kLatencyBuckets) {
+        return std::chrono::microseconds{0};
+    }
+    return std::chrono::microseconds{int64_t{1} << bucket};
+}
+
+size_t GetLatencyBucket(std::chrono::nanoseconds latency) {
+    auto microseconds = std::chrono::ceil<std::chrono::microseconds>(latency).count();
+    if (microseconds <= 1) {
+        return 0;
+    }
+    return std::min<size_t>(std::bit_width(uint64_t(microseconds - 1)), kLatencyBuckets - 1);
+}
+
+std::string FormatJson(const InterpreterStats& stats) {
+    std::string out = "{\"requests\":" + std::to_string(stats.requests);
+    out += ",\"request_time_ns\":" + std::to_string(stats.request_time.count());
+
+    out += ",\"request_latency_us\":[";
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+        auto bound = GetLatencyBucketBound(i).count();
+        out += i ? "," : "";
+        out += "{\"le\":" + (bound ? std::to_string(bound) : std::string("null")) +
+               ",\"count\":" + std::to_string(stats.request_latency[i]) + "}";
+    }
+    out += "]";
+
+    out += ",\"phases_ns\":{\"read\":" + std::to_string(stats.read_time.count()) +
+           ",\"eval\":" + std::to_string(stats.eval_time.count()) +
+           ",\"print\":" + std::to_string(stats.print_time.count()) + "}";
+
+    // Builtin names are plain ASCII without quotes or backslashes.
+    out += ",\"builtins\":[";
+    for (size_t i = 0; i < stats.builtins.size(); ++i) {
+        const auto& builtin = stats.builtins[i];
+        out += i ? "," : "";
+        out += "{\"name\":\"" + builtin.name + "\",\"calls\":" + std::to_string(builtin.calls) +
+               ",\"time_ns\":" + std::to_string(builtin.time.count()) + "}";
+    }
+    out += "]";
+
+    out += ",\"objects_made\":{";
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        out += i ? "," : "";
+        out += "\"" + std::string(kTypeNames[i]) + "\":" + std::to_string(stats.objects_made[i]);
+    }
+    out += "}}";
+    return out;
+}
+
+std::string FormatPrometheus(const InterpreterStats& stats) {
+    std::string out;
+
+    out += "# TYPE scheme_request_seconds histogram\n";
+    size_t cumulative = 0;
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+        cumulative += stats.request_latency[i];
+        auto bound = GetLatencyBucketBound(i);
+        out += "scheme_request_seconds_bucket{le=\"" +
+               (bound.count() ? FormatSeconds(bound) : std::string("+Inf")) +
+               "\"} " + std::to_string(cumulative) + "\n";
+    }
+    out += "scheme_request_seconds_sum " + FormatSeconds(stats.request_time) + "\n";
+    out += "scheme_request_seconds_count " + std::to_string(stats.requests) + "\n";
+
+    out += "# TYPE scheme_phase_seconds_total counter\n";
+    out += "scheme_phase_seconds_total{phase=\"read\"} " + FormatSeconds(stats.read_time) + "\n";
+    out += "scheme_phase_seconds_total{phase=\"eval\"} " + FormatSeconds(stats.eval_time) + "\n";
+    out += "scheme_phase_seconds_total{phase=\"print\"} " + FormatSeconds(stats.print_time) + "\n";
+
+    out += "# TYPE scheme_builtin_calls_total counter\n";
+    for (const auto& builtin : stats.builtins) {
+        out += "scheme_builtin_calls_total{builtin=\"" + builtin.name + "\"} " +
+               std::to_string(builtin.calls) + "\n";
+    }
+    out += "# TYPE scheme_builtin_seconds_total counter\n";
+    for (const auto& builtin : stats.builtins) {
+        out += "scheme_builtin_seconds_total{builtin=\"" + builtin.name + "\"} " +
+               FormatSeconds(builtin.time) + "\n";
+    }
+
+    out += "# TYPE scheme_objects_made_total counter\n";
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        out += "scheme_objects_made_total{type=\"" + std::string(kTypeNames[i]) + "\"} " +
+               std::to_string(stats.objects_made[i]) + "\n";
+    }
+    return out;
+}
+
+CallCounters::CallCounters(size_t size) : counters_(std::make_unique<Counter[]>(size)) {
+}
+
+CallCounters::Scope::Scope(CallCounters* counters, size_t id)
+    : counters_(counters), id_(id), start_(std::chrono::steady_clock::now()) {
+}
+
+CallCounters::Scope::~Scope() {
+    auto time = std::chrono::steady_clock::now() - start_;
+    auto& counter = counters_->counters_[id_];
+    counter.calls.fetch_add(1, std::memory_order_relaxed);
+    counter.nanoseconds.fetch_add(std::chrono::nanoseconds(time).count(),
+                                  std::memory_order_relaxed);
+}
+
+size_t CallCounters::GetCalls(size_t id) const {
+    return counters_[id].calls.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds CallCounters::GetTime(size_t id) const {
+    return std::chrono::nanoseconds(counters_[id].nanoseconds.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+struct BuiltinStats {
+    std::string name;
+    size_t calls = 0;
+    // Special forms evaluate their arguments themselves, so their time
+    // includes those evaluations.
+    std::chrono::nanoseconds time{0};
+};
+
+// Requests taking up to 1us, 2us, 4us, ... 2^(kLatencyBuckets - 2)us, and
+// longer ones in the last bucket.
+inline constexpr size_t kLatencyBuckets = 22;
+
+struct InterpreterStats {
+    // Requests that ran to completion and how long they took. Failed ones
+    // still show up in the phases, builtin calls and objects made.
+    size_t requests = 0;
+    std::chrono::nanoseconds request_time{0};
+    // Counts of requests by how long they took, see kLatencyBuckets.
+    std::array<size_t, kLatencyBuckets> request_latency{};
+
+    // Time spent in each phase of Run. The tokenizer runs on demand of the
+    // parser, so the two make up one phase.
+    std::chrono::nanoseconds read_time{0};
+    std::chrono::nanoseconds eval_time{0};
+    std::chrono::nanoseconds print_time{0};
+
+    // Builtins called at least once, in order of registration.
+    std::vector<BuiltinStats> builtins;
+
+    // Objects made so far, by type, on the heap or in a request's arena.
+    // Booleans and small numbers are shared constants and never made; the
+    // symbol count is that of the names the interpreter's requests interned
+    // beyond the builtins.
+    std::array<size_t, kObjectTypeCount> objects_made{};
+};
+
+// Upper bound of a latency bucket, or zero for the last, unbounded one.
+std::chrono::microseconds GetLatencyBucketBound(size_t bucket);
+size_t GetLatencyBucket(std::chrono::nanoseconds latency);
+
+// The stats as one JSON object, and in the Prometheus text format, all
+// metrics prefixed with "scheme_".
+std::string FormatJson(const InterpreterStats& stats);
+std::string FormatPrometheus(const InterpreterStats& stats);
+
+// Calls and time per builtin, filled by Function::Apply while an Interpreter
+// runs with instrumentation on. Builtins are indexed by the id of the symbol
+// naming them. Counters are atomic, as parallel evaluation records calls
+// from several threads at once.
+class CallCounters {
+public:
+    // Ids of builtins are below size.
+    explicit CallCounters(size_t size);
+
+    // Counts one call of the builtin with this id, lasting as long as the
+    // scope does.
+    class Scope {
+    public:
+        Scope(CallCounters* counters, size_t id);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        CallCounters* counters_;
+        size_t id_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    size_t GetCalls(size_t id) const;
+    std::chrono::nanoseconds GetTime(size_t id) const;
+
+private:
+    struct Counter {
+        std::atomic<size_t> calls = 0;
+        std::atomic<int64_t> nanoseconds = 0;
+    };
+
+    std::unique_ptr<Counter[]> counters_;
+};
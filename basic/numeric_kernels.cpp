@@ -0,0 +1,313 @@
+#include "numeric_kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCHEME_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+enum class Relation { kEqual, kLess, kGreater, kLessEqual, kGreaterEqual };
+
+template <Relation R>
+bool Holds(int64_t lhs, int64_t rhs) {
+    if constexpr (R == Relation::kEqual) {
+        return lhs == rhs;
+    } else if constexpr (R == Relation::kLess) {
+        return lhs < rhs;
+    } else if constexpr (R == Relation::kGreater) {
+        return lhs > rhs;
+    } else if constexpr (R == Relation::kLessEqual) {
+        return lhs <= rhs;
+    } else {
+        return lhs >= rhs;
+    }
+}
+
+// Scalar loops, also used for the tails the vector kernels leave over.
+
+bool SumScalar(const int64_t* values, size_t count, int64_t* res) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (__builtin_add_overflow(sum, values[i], &sum)) {
+            return false;
+        }
+    }
+    *res = sum;
+    return true;
+}
+
+// Adds the lanes of a vector sum and the scalar tail.
+bool FinishSum(const int64_t* lanes, size_t lane_count, const int64_t* tail, size_t tail_count,
+               int64_t* res) {
+    int64_t sum;
+    if (!SumScalar(tail, tail_count, &sum)) {
+        return false;
+    }
+    for (size_t i = 0; i < lane_count; ++i) {
+        if (__builtin_add_overflow(sum, lanes[i], &sum)) {
+            return false;
+        }
+    }
+    *res = sum;
+    return true;
+}
+
+int64_t MaxScalar(const int64_t* values, size_t count) {
+    return *std::max_element(values, values + count);
+}
+
+int64_t MinScalar(const int64_t* values, size_t count) {
+    return *std::min_element(values, values + count);
+}
+
+template <Relation R>
+bool PairwiseScalar(const int64_t* values, size_t count) {
+    for (size_t i = 0; i + 1 < count; ++i) {
+        if (!Holds<R>(values[i], values[i + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SCHEME_X86_KERNELS
+
+// SSE4.2 is the first level with a 64-bit signed compare, two lanes wide.
+
+// A lane overflowed if both addends have the same sign and the sum has the
+// other one: collects such sign bits into overflow.
+__attribute__((target("sse4.2"))) __m128i AddCheckedSse42(__m128i acc, __m128i value,
+                                                          __m128i* overflow) {
+    auto sum = _mm_add_epi64(acc, value);
+    *overflow = _mm_or_si128(
+        *overflow, _mm_and_si128(_mm_xor_si128(acc, sum), _mm_xor_si128(value, sum)));
+    return sum;
+}
+
+__attribute__((target("sse4.2"))) bool SumSse42(const int64_t* values, size_t count,
+                                                int64_t* res) {
+    __m128i acc = _mm_setzero_si128();
+    __m128i overflow = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        acc = AddCheckedSse42(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)),
+                              &overflow);
+    }
+    if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) {
+        return false;
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return FinishSum(lanes, 2, values + i, count - i, res);
+}
+
+template <bool kMax>
+__attribute__((target("sse4.2"))) int64_t ExtremumSse42(const int64_t* values, size_t count) {
+    if (count < 2) {
+        return values[0];
+    }
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    size_t i = 2;
+    for (; i + 2 <= count; i += 2) {
+        auto cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        auto take = kMax ? _mm_cmpgt_epi64(cur, acc) : _mm_cmpgt_epi64(acc, cur);
+        acc = _mm_blendv_epi8(acc, cur, take);
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    auto res = kMax ? std::max(lanes[0], lanes[1]) : std::min(lanes[0], lanes[1]);
+    for (; i < count; ++i) {
+        res = kMax ? std::max(res, values[i]) : std::min(res, values[i]);
+    }
+    return res;
+}
+
+template <Relation R>
+__attribute__((target("sse4.2"))) __m128i PairMaskSse42(__m128i lhs, __m128i rhs) {
+    if constexpr (R == Relation::kEqual) {
+        return _mm_cmpeq_epi64(lhs, rhs);
+    } else if constexpr (R == Relation::kLess) {
+        return _mm_cmpgt_epi64(rhs, lhs);
+    } else if constexpr (R == Relation::kGreater) {
+        return _mm_cmpgt_epi64(lhs, rhs);
+    } else if constexpr (R == Relation::kLessEqual) {
+        return _mm_xor_si128(_mm_cmpgt_epi64(lhs, rhs), _mm_set1_epi64x(-1));
+    } else {
+        return _mm_xor_si128(_mm_cmpgt_epi64(rhs, lhs), _mm_set1_epi64x(-1));
+    }
+}
+
+// Compares values[i..i+1] against values[i+1..i+2] with two overlapping loads.
+template <Relation R>
+__attribute__((target("sse4.2"))) bool PairwiseSse42(const int64_t* values, size_t count) {
+    size_t i = 0;
+    for (; i + 3 <= count; i += 2) {
+        auto lhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        auto rhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 1));
+        if (_mm_movemask_pd(_mm_castsi128_pd(PairMaskSse42<R>(lhs, rhs))) != 0x3) {
+            return false;
+        }
+    }
+    return PairwiseScalar<R>(values + i, count - i);
+}
+
+// AVX2: the same kernels four lanes wide.
+
+__attribute__((target("avx2"))) __m256i AddCheckedAvx2(__m256i acc, __m256i value,
+                                                       __m256i* overflow) {
+    auto sum = _mm256_add_epi64(acc, value);
+    *overflow = _mm256_or_si256(
+        *overflow, _mm256_and_si256(_mm256_xor_si256(acc, sum), _mm256_xor_si256(value, sum)));
+    return sum;
+}
+
+__attribute__((target("avx2"))) bool SumAvx2(const int64_t* values, size_t count, int64_t* res) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i overflow = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = AddCheckedAvx2(
+            acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), &overflow);
+        acc1 = AddCheckedAvx2(
+            acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 4)),
+            &overflow);
+    }
+    auto acc = AddCheckedAvx2(acc0, acc1, &overflow);
+    if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) {
+        return false;
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return FinishSum(lanes, 4, values + i, count - i, res);
+}
+
+template <bool kMax>
+__attribute__((target("avx2"))) int64_t ExtremumAvx2(const int64_t* values, size_t count) {
+    if (count < 4) {
+        return kMax ? MaxScalar(values, count) : MinScalar(values, count);
+    }
+    __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        auto cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        auto take = kMax ? _mm256_cmpgt_epi64(cur, acc) : _mm256_cmpgt_epi64(acc, cur);
+        acc = _mm256_blendv_epi8(acc, cur, take);
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    auto res = lanes[0];
+    for (size_t lane = 1; lane < 4; ++lane) {
+        res = kMax ? std::max(res, lanes[lane]) : std::min(res, lanes[lane]);
+    }
+    for (; i < count; ++i) {
+        res = kMax ? std::max(res, values[i]) : std::min(res, values[i]);
+    }
+    return res;
+}
+
+template <Relation R>
+__attribute__((target("avx2"))) __m256i PairMaskAvx2(__m256i lhs, __m256i rhs) {
+    if constexpr (R == Relation::kEqual) {
+        return _mm256_cmpeq_epi64(lhs, rhs);
+    } else if constexpr (R == Relation::kLess) {
+        return _mm256_cmpgt_epi64(rhs, lhs);
+    } else if constexpr (R == Relation::kGreater) {
+        return _mm256_cmpgt_epi64(lhs, rhs);
+    } else if constexpr (R == Relation::kLessEqual) {
+        return _mm256_xor_si256(_mm256_cmpgt_epi64(lhs, rhs), _mm256_set1_epi64x(-1));
+    } else {
+        return _mm256_xor_si256(_mm256_cmpgt_epi64(rhs, lhs), _mm256_set1_epi64x(-1));
+    }
+}
+
+template <Relation R>
+__attribute__((target("avx2"))) bool PairwiseAvx2(const int64_t* values, size_t count) {
+    size_t i = 0;
+    for (; i + 5 <= count; i += 4) {
+        auto lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        auto rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 1));
+        if (_mm256_movemask_pd(_mm256_castsi256_pd(PairMaskAvx2<R>(lhs, rhs))) != 0xF) {
+            return false;
+        }
+    }
+    return PairwiseScalar<R>(values + i, count - i);
+}
+
+#endif  // SCHEME_X86_KERNELS
+
+constexpr NumericKernels kScalarKernels{
+    SumScalar,
+    MaxScalar,
+    MinScalar,
+    PairwiseScalar<Relation::kEqual>,
+    PairwiseScalar<Relation::kLess>,
+    PairwiseScalar<Relation::kGreater>,
+    PairwiseScalar<Relation::kLessEqual>,
+    PairwiseScalar<Relation::kGreaterEqual>,
+};
+
+#ifdef SCHEME_X86_KERNELS
+constexpr NumericKernels kSse42Kernels{
+    SumSse42,
+    ExtremumSse42<true>,
+    ExtremumSse42<false>,
+    PairwiseSse42<Relation::kEqual>,
+    PairwiseSse42<Relation::kLess>,
+    PairwiseSse42<Relation::kGreater>,
+    PairwiseSse42<Relation::kLessEqual>,
+    PairwiseSse42<Relation::kGreaterEqual>,
+};
+
+constexpr NumericKernels kAvx2Kernels{
+    SumAvx2,
+    ExtremumAvx2<true>,
+    ExtremumAvx2<false>,
+    PairwiseAvx2<Relation::kEqual>,
+    PairwiseAvx2<Relation::kLess>,
+    PairwiseAvx2<Relation::kGreater>,
+    PairwiseAvx2<Relation::kLessEqual>,
+    PairwiseAvx2<Relation::kGreaterEqual>,
+};
+#endif
+
+SimdLevel Detect() {
+#ifdef SCHEME_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return SimdLevel::kSse42;
+    }
+#endif
+    return SimdLevel::kScalar;
+}
+
+}  // namespace
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel kLevel = Detect();
+    return kLevel;
+}
+
+const NumericKernels& GetNumericKernels(SimdLevel level) {
+    switch (level) {
+#ifdef SCHEME_X86_KERNELS
+        case SimdLevel::kAvx2:
+            return kAvx2Kernels;
+        case SimdLevel::kSse42:
+            return kSse42Kernels;
+#endif
+        default:
+            return kScalarKernels;
+    }
+}
+
+const NumericKernels& GetNumericKernels() {
+    static const NumericKernels& kKernels = GetNumericKernels(DetectSimdLevel());
+    return kKernels;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Reductions behind the variadic number builtins, run over arguments that
+// have already been unboxed into contiguous memory. The vector kernel sets
+// agree with the scalar one except where noted; they only get there faster.
+enum class SimdLevel { kScalar, kSse42, kAvx2 };
+
+struct NumericKernels {
+    // Stores the sum and returns true, or returns false if some partial sum
+    // overflowed. The vector kernels add in a different order than the
+    // scalar one, so they may give up on sums that the scalar one finishes;
+    // a true result is always exact.
+    bool (*sum)(const int64_t* values, size_t count, int64_t* res);
+    // Max and min need at least one value.
+    int64_t (*max)(const int64_t* values, size_t count);
+    int64_t (*min)(const int64_t* values, size_t count);
+
+    // True when every adjacent pair satisfies the relation, so always true
+    // for fewer than two values.
+    bool (*equal)(const int64_t* values, size_t count);
+    bool (*less)(const int64_t* values, size_t count);
+    bool (*greater)(const int64_t* values, size_t count);
+    bool (*less_equal)(const int64_t* values, size_t count);
+    bool (*greater_equal)(const int64_t* values, size_t count);
+};
+
+// The widest level this CPU runs, checked once.
+SimdLevel DetectSimdLevel();
+
+// Kernels for the given level, which must not exceed DetectSimdLevel().
+const NumericKernels& GetNumericKernels(SimdLevel level);
+// Kernels for DetectSimdLevel().
+const NumericKernels& GetNumericKernels();
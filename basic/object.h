@@ -1,62 +1,154 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
-#include <memory>
 #include <vector>
-#include <functional>
 
-class Object : public std::enable_shared_from_this<Object> {
+#include "big_int.h"
+
+struct Context;
+class Heap;
+class Printer;
+
+// Concrete type of an object, stored in every object so that type checks are
+// a plain compare rather than RTTI.
+enum class ObjectType : uint8_t {
+    kNumber,
+    kSymbol,
+    kFunction,
+    kBool,
+    kDot,
+    kCell,
+    kList,
+};
+
+inline constexpr size_t kObjectTypeCount = 7;
+
+// Objects are referenced by plain pointers. Those made at runtime are owned
+// by a Heap and freed by its collector; see heap.h.
+class Object {
 public:
+    explicit Object(ObjectType type) : type_(type) {
+    }
     virtual ~Object() = default;
-    virtual std::shared_ptr<Object> Eval() = 0;
+
+    ObjectType GetType() const {
+        return type_;
+    }
+
+    virtual Object* Eval(Context* context) = 0;
     virtual std::string Serialize() = 0;
+
+    // Writes the same text Serialize returns. The default goes through
+    // Serialize; lists and the common atoms write straight into the printer.
+    virtual void Print(Printer* printer);
+
+    // Offset into the source of the bracket or quote the reader made this
+    // list from. Nodes made otherwise, and offsets past 4 GiB, have none.
+    static constexpr uint32_t kNoSourceOffset = UINT32_MAX;
+    uint32_t GetSourceOffset() const {
+        return source_offset_;
+    }
+    void SetSourceOffset(size_t offset) {
+        source_offset_ = offset < kNoSourceOffset ? offset : kNoSourceOffset;
+    }
+
+private:
+    friend class Heap;
+
+    // Bookkeeping of the owning Heap, left untouched for objects owned
+    // elsewhere.
+    Object* gc_next_ = nullptr;
+    // Shares the word with the collector's fields, so positions cost no
+    // memory.
+    uint32_t source_offset_ = kNoSourceOffset;
+    bool gc_tracked_ = false;
+    bool gc_marked_ = false;
+
+    // Fits into the padding after the collector's fields.
+    ObjectType type_;
 };
 
 class Number : public Object {
 public:
-    Number(int val);
-    std::shared_ptr<Object> Eval() override;
+    static constexpr ObjectType kType = ObjectType::kNumber;
+
+    Number(int64_t val);
+    // For values that do not fit into int64_t; MakeNumber picks the form.
+    explicit Number(BigInt val);
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
+    void Print(Printer* printer) override;
 
-    int GetValue() const;
+    bool IsBig() const;
+    // Only for numbers that are not big.
+    int64_t GetValue() const;
+    BigInt GetBigValue() const;
 
 private:
-    int value_;
+    int64_t value_ = 0;
+    std::unique_ptr<const BigInt> big_;
 };
 
 class Symbol : public Object {
 public:
-    Symbol(std::string name);
+    static constexpr ObjectType kType = ObjectType::kSymbol;
+
+    Symbol(std::string name, size_t id);
 
-    std::shared_ptr<Object> Eval() override;
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
+    void Print(Printer* printer) override;
 
     const std::string& GetName() const;
+    size_t GetId() const;
 
 private:
     std::string name_;
+    size_t id_;
 };
 
 class Function : public Object {
 public:
-    Function(std::string name);
+    static constexpr ObjectType kType = ObjectType::kFunction;
+
+    // Arguments are lent to the function for the duration of the call only.
+    using Args = std::span<Object* const>;
+    using Impl = Object* (*)(Context*, Args);
+
+    // A special form receives its arguments unevaluated; every other function
+    // gets them already evaluated, left to right. The id is that of the
+    // symbol naming the function.
+    Function(std::string name, size_t id, Impl impl, bool special_form = false);
 
-    std::shared_ptr<Object> Eval() override;
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
 
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args);
+    const std::string& GetName() const;
+    size_t GetId() const;
+    bool IsSpecialForm() const;
+
+    Object* Apply(Context* context, Args args);
 
 private:
-    std::function<std::shared_ptr<Object>(std::vector<std::shared_ptr<Object>>&)> func_;
+    std::string name_;
+    size_t id_;
+    Impl func_;
+    bool special_form_;
 };
 
 class Bool : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::kBool;
+
     Bool(std::string val);
     Bool(bool val);
 
-    std::shared_ptr<Object> Eval() override;
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
 
     bool GetBool();
@@ -65,45 +157,93 @@ private:
     bool bool_;
 };
 
+// Numbers and booleans are immutable, so both booleans and small integers are
+// preallocated once and shared by every result instead of being allocated.
+// Other numbers are made on the heap.
+Number* MakeNumber(Heap* heap, int64_t value);
+// Back to a plain int64_t number when the value fits.
+Number* MakeNumber(Heap* heap, BigInt value);
+Bool* MakeBool(bool value);
+
 class Dot : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::kDot;
+
     Dot();
-    std::shared_ptr<Object> Eval() override;
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
 };
 
 class Cell : public Object {
 public:
+    static constexpr ObjectType kType = ObjectType::kCell;
+
     Cell();
 
-    std::shared_ptr<Object> Eval() override;
+    Object* Eval(Context* context) override;
+    std::string Serialize() override;
+    void Print(Printer* printer) override;
+
+    Object* GetFirst() const;
+    Object* GetSecond() const;
+    Object*& GetFirst();
+    Object*& GetSecond();
+
+private:
+    Object* first_ = nullptr;
+    Object* second_ = nullptr;
+};
+
+// A list stored as one array of elements followed by the tail that ends it:
+// nullptr for a proper list, otherwise an atom. Reads exactly like the
+// equivalent chain of Cells, but indexing, counting and taking a suffix are
+// O(1), and suffixes share the array instead of copying it.
+//
+// Lists are never modified. Code that needs to change one converts it to
+// Cells with ToCells and works on those.
+class List : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kList;
+
+    // items must not be empty; they stay in whatever memory resource they
+    // were allocated from.
+    List(std::pmr::vector<Object*> items, Object* tail);
+    // The elements of base from offset on, offset < base->Size().
+    List(List* base, size_t offset);
+
+    Object* Eval(Context* context) override;
     std::string Serialize() override;
+    void Print(Printer* printer) override;
 
-    std::shared_ptr<Object> GetFirst() const;
-    std::shared_ptr<Object> GetSecond() const;
-    std::shared_ptr<Object>& GetFirst();
-    std::shared_ptr<Object>& GetSecond();
+    size_t Size() const;
+    Object* At(size_t index) const;
+    Object* GetTail() const;
+    // The list that owns the array, which has to stay alive with this one.
+    List* GetBase() const;
+
+    // The list without its first count elements, count < Size().
+    List* Suffix(size_t count, Heap* heap);
+    Cell* ToCells(Heap* heap) const;
 
 private:
-    std::shared_ptr<Object> first_ = nullptr;
-    std::shared_ptr<Object> second_ = nullptr;
+    std::pmr::vector<Object*> items_;
+    List* base_;
+    size_t offset_;
+    Object* tail_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 // Runtime type checking and convertion.
-// This can be helpful: https://en.cppreference.com/w/cpp/memory/shared_ptr/pointer_cast
 
 template <class T>
-std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
-    return std::dynamic_pointer_cast<T>(obj);
+bool Is(Object* obj) {
+    return obj != nullptr && obj->GetType() == T::kType;
 }
 
+// The object must be a T or nullptr; check with Is first.
 template <class T>
-bool Is(const std::shared_ptr<Object>& obj) {
-    auto ptr = std::dynamic_pointer_cast<T>(obj);
-    if (ptr) {
-        return true;
-    }
-    return false;
+T* As(Object* obj) {
+    assert(obj == nullptr || Is<T>(obj));
+    return static_cast<T*>(obj);
 }
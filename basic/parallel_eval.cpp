@@ -0,0 +1,63 @@
+#include "parallel_eval.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "argument_stack.h"
+#include "heap.h"
+#include "profiler.h"
+#include "work_stealing_pool.h"
+
+namespace {
+
+// Chunks per thread: enough that a thread stuck on a slow chunk leaves the
+// rest for the others to steal, few enough to keep the per-chunk heaps and
+// queue traffic cheap.
+constexpr size_t kChunksPerThread = 4;
+
+}  // namespace
+
+void ParallelEval(Context* context, std::span<Object*> out, size_t min_chunk,
+                  const std::function<Object*(size_t, Context*)>& eval) {
+    auto pool = context->pool;
+    // Work too small to split never starts the shared pool.
+    if (pool == nullptr && context->shared_pool && out.size() > std::max<size_t>(1, min_chunk)) {
+        pool = &WorkStealingPool::Shared();
+    }
+    size_t threads = pool ? pool->GetConcurrency() : 1;
+    size_t chunk = std::max<size_t>({1, min_chunk, out.size() / (threads * kChunksPerThread)});
+    if (threads == 1 || out.size() <= chunk) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = eval(i, context);
+        }
+        return;
+    }
+
+    // Until they are adopted, a chunk's objects are referenced from out
+    // only, so when some call fails they are all simply freed.
+    std::vector<std::unique_ptr<Heap>> heaps((out.size() + chunk - 1) / chunk);
+    auto caller = std::this_thread::get_id();
+    pool->ParallelFor(out.size(), chunk, [&](size_t begin, size_t end) {
+        // Any other thread may be waiting inside an evaluation of its own,
+        // whose calls are not this chunk's.
+        std::optional<SamplingProfiler::SetAsideScope> set_aside;
+        if (std::this_thread::get_id() != caller) {
+            set_aside.emplace();
+        }
+        auto& heap = heaps[begin / chunk];
+        heap = std::make_unique<Heap>();
+        ArgumentStack arguments;
+        Context local = *context;
+        local.heap = heap.get();
+        local.arguments = &arguments;
+        for (size_t i = begin; i < end; ++i) {
+            out[i] = eval(i, &local);
+        }
+    });
+    for (auto& heap : heaps) {
+        context->heap->Adopt(heap.get());
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+
+#include "context.h"
+#include "object.h"
+
+// Stores eval(i, context) into out[i] for every i, spread over the threads
+// of context's pool in chunks of at least min_chunk calls. Every chunk
+// evaluates with a heap and an argument stack of its own; the heaps go over
+// to context->heap once all calls are done. Too few calls, or no pool, and
+// the loop simply runs on the calling thread.
+//
+// If some calls throw, the exception of the lowest i is rethrown, so the
+// error is the one a plain loop would have raised.
+void ParallelEval(Context* context, std::span<Object*> out, size_t min_chunk,
+                  const std::function<Object*(size_t, Context*)>& eval);
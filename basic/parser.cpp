@@ -1,54 +1,148 @@
 #include <parser.h>
+#include <algorithm>
 #include <vector>
 #include <error.h>
 
-Number::Number(int val) : value_(val) {
+Number::Number(int64_t val) : Object(kType), value_(val) {
 }
-int Number::GetValue() const {
+Number::Number(BigInt val) : Object(kType), big_(std::make_unique<const BigInt>(std::move(val))) {
+}
+bool Number::IsBig() const {
+    return big_ != nullptr;
+}
+int64_t Number::GetValue() const {
+    assert(!IsBig());
     return value_;
 }
+BigInt Number::GetBigValue() const {
+    return IsBig() ? *big_ : BigInt(value_);
+}
 
-Symbol::Symbol(std::string name) : name_(std::move(name)) {
+Symbol::Symbol(std::string name, size_t id)
+    : Object(kType), name_(std::move(name)), id_(id) {
 }
 const std::string& Symbol::GetName() const {
     return name_;
 }
+size_t Symbol::GetId() const {
+    return id_;
+}
 
-Cell::Cell() {
+Cell::Cell() : Object(kType) {
 }
 
-std::shared_ptr<Object> Cell::GetFirst() const {
+Object* Cell::GetFirst() const {
     return first_;
 }
-std::shared_ptr<Object> Cell::GetSecond() const {
+Object* Cell::GetSecond() const {
     return second_;
 }
-std::shared_ptr<Object>& Cell::GetFirst() {
+Object*& Cell::GetFirst() {
     return first_;
 }
-std::shared_ptr<Object>& Cell::GetSecond() {
+Object*& Cell::GetSecond() {
     return second_;
 }
 
-Dot::Dot() {
+Dot::Dot() : Object(kType) {
+}
+
+List::List(std::pmr::vector<Object*> items, Object* tail)
+    : Object(kType), items_(std::move(items)), base_(this), offset_(0), tail_(tail) {
+}
+List::List(List* base, size_t offset)
+    : Object(kType), base_(base->base_), offset_(base->offset_ + offset), tail_(base->tail_) {
+}
+size_t List::Size() const {
+    return base_->items_.size() - offset_;
+}
+Object* List::At(size_t index) const {
+    return base_->items_[offset_ + index];
+}
+Object* List::GetTail() const {
+    return tail_;
+}
+List* List::GetBase() const {
+    return base_;
+}
+List* List::Suffix(size_t count, Heap* heap) {
+    if (count == 0) {
+        return this;
+    }
+    return heap->Make<List>(this, count);
+}
+Cell* List::ToCells(Heap* heap) const {
+    auto to_ret = heap->Make<Cell>();
+    auto cur = to_ret;
+    for (size_t i = 0; i < Size(); ++i) {
+        cur->GetFirst() = At(i);
+        if (i + 1 < Size()) {
+            cur->GetSecond() = heap->Make<Cell>();
+            cur = As<Cell>(cur->GetSecond());
+        }
+    }
+    cur->GetSecond() = tail_;
+    return to_ret;
 }
 
-Bool::Bool(std::string b) {
+Bool::Bool(std::string b) : Object(kType) {
     if (b == "#t") {
         bool_ = true;
     } else {
         bool_ = false;
     }
 }
-Bool::Bool(bool val) {
+Bool::Bool(bool val) : Object(kType) {
     bool_ = val;
 }
 bool Bool::GetBool() {
     return bool_;
 }
 
-std::shared_ptr<Object> ListASTFromVector(std::vector<std::shared_ptr<Object>> list) {
-    std::shared_ptr<Object> to_ret = std::make_shared<Cell>();
+Number* MakeNumber(Heap* heap, int64_t value) {
+    static constexpr int kMinCached = -128;
+    static constexpr int kMaxCached = 1023;
+    static auto kCache = [] {
+        std::vector<Number> cache;
+        for (int i = kMinCached; i <= kMaxCached; ++i) {
+            cache.emplace_back(i);
+        }
+        return cache;
+    }();
+    if (value < kMinCached || value > kMaxCached) {
+        return heap->Make<Number>(value);
+    }
+    return &kCache[value - kMinCached];
+}
+
+Number* MakeNumber(Heap* heap, BigInt value) {
+    if (value.FitsInt64()) {
+        return MakeNumber(heap, value.ToInt64());
+    }
+    return heap->Make<Number>(std::move(value));
+}
+
+Bool* MakeBool(bool value) {
+    static Bool kTrue(true);
+    static Bool kFalse(false);
+    return value ? &kTrue : &kFalse;
+}
+
+// Places the node in the arena if there is one, or makes it on the heap.
+// Arena nodes are never destroyed, which is fine for the node types the
+// reader builds: none of them own any memory.
+template <class T, class... Args>
+T* MakeNode(Heap* heap, std::pmr::memory_resource* arena, Args&&... args) {
+    if (!arena) {
+        return heap->Make<T>(std::forward<Args>(args)...);
+    }
+    heap->CountArenaObject(T::kType);
+    return new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+Object* ListASTFromVector(std::vector<Object*> list, Heap* heap,
+                          std::pmr::memory_resource* arena) {
+    Object* to_ret = MakeNode<Cell>(heap, arena);
     if (list.empty()) {
         return to_ret;
     }
@@ -64,7 +158,7 @@ std::shared_ptr<Object> ListASTFromVector(std::vector<std::shared_ptr<Object>> l
         } else {
             As<Cell>(cur)->GetFirst() = list[i];
             if (i != list.size() - 1) {
-                As<Cell>(cur)->GetSecond() = std::make_shared<Cell>();
+                As<Cell>(cur)->GetSecond() = MakeNode<Cell>(heap, arena);
             }
         }
         prev = cur;
@@ -73,65 +167,278 @@ std::shared_ptr<Object> ListASTFromVector(std::vector<std::shared_ptr<Object>> l
     return to_ret;
 }
 
-std::shared_ptr<Object> ReadImpl(Tokenizer* tokenizer);
-
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-    tokenizer->Next();
-    std::vector<std::shared_ptr<Object>> list;
-    while (true) {
-        if (IsCloseBracket(tokenizer->GetToken())) {
-            break;
+Object* MakeList(std::vector<Object*> list, Heap* heap, std::pmr::memory_resource* arena) {
+    if (list.empty()) {
+        return MakeNode<Cell>(heap, arena);
+    }
+    auto dot = std::find_if(list.begin(), list.end(), [](Object* obj) { return Is<Dot>(obj); });
+    Object* tail = nullptr;
+    if (dot != list.end()) {
+        if (dot == list.begin() || dot + 2 != list.end()) {
+            throw SyntaxError("Wrong Syntax");
+        }
+        tail = list.back();
+        if (Is<Cell>(tail)) {
+            return ListASTFromVector(std::move(list), heap, arena);
+        }
+        list.erase(dot, list.end());
+        if (Is<List>(tail)) {
+            auto rest = As<List>(tail);
+            for (size_t i = 0; i < rest->Size(); ++i) {
+                list.push_back(rest->At(i));
+            }
+            tail = rest->GetTail();
         }
-        list.push_back(ReadImpl(tokenizer));
     }
-    if (list.empty()) {
-        return nullptr;
+    std::pmr::vector<Object*> items(list.begin(), list.end(),
+                                    arena ? arena : std::pmr::get_default_resource());
+    return MakeNode<List>(heap, arena, std::move(items), tail);
+}
+
+namespace {
+
+// A list or quote the reader is inside of. Lists collect their elements;
+// a quote wraps the single datum that follows it.
+struct ReadFrame {
+    bool quote = false;
+    // Inside a quote, where lists are data and are stored as Lists rather
+    // than as Cells the evaluator walks.
+    bool data = false;
+    // In the dotted tail of a call, whose elements it only continues: they
+    // are more operands of that call, and a quote at its head quotes
+    // nothing.
+    bool spliced = false;
+    std::vector<Object*> items;
+    // Of the opening bracket or quote, for the node the frame turns into.
+    size_t offset = 0;
+};
+
+[[noreturn]] void ThrowSyntaxError(const SourcePosition& position, std::string_view message) {
+    throw SyntaxError(std::string(message) + " at " + FormatSourcePosition(position));
+}
+
+// A dot must come second to last and not first.
+bool HasMisplacedDot(const std::vector<Object*>& list) {
+    auto dot = std::find_if(list.begin(), list.end(), [](Object* obj) { return Is<Dot>(obj); });
+    return dot != list.end() && (dot == list.begin() || dot + 2 != list.end());
+}
+
+bool IsData(const std::vector<ReadFrame>& frames) {
+    if (frames.empty()) {
+        return false;
+    }
+    const auto& parent = frames.back();
+    if (parent.data) {
+        return true;
+    }
+    if (parent.spliced) {
+        return false;
+    }
+    return parent.quote ||
+           (!parent.items.empty() && Is<Symbol>(parent.items.front()) &&
+            As<Symbol>(parent.items.front())->GetId() == SymbolTable::kQuote);
+}
+
+// Whether a list or quote opened now is the dotted tail of code, as in
+// (and . (quote (+ 1 2))), which reads the same as (and quote (+ 1 2)).
+bool IsSplicedTail(const std::vector<ReadFrame>& frames) {
+    if (frames.empty() || frames.back().quote || frames.back().data) {
+        return false;
     }
-    return ListASTFromVector(list);
+    const auto& items = frames.back().items;
+    return !items.empty() && Is<Dot>(items.back());
 }
 
-std::shared_ptr<Object> ReadImpl(Tokenizer* tokenizer) {
-    auto token = tokenizer->GetToken();
-    std::shared_ptr<Object> to_ret;
+Object* MakeQuote(Object* argument, SymbolTable* symbols, Heap* heap,
+                  std::pmr::memory_resource* arena) {
+    auto to_ret = MakeNode<Cell>(heap, arena);
+    to_ret->GetFirst() = symbols->Get(SymbolTable::kQuote);
+    auto second_cell = MakeNode<Cell>(heap, arena);
+    second_cell->GetFirst() = argument;
+    to_ret->GetSecond() = second_cell;
+    return to_ret;
+}
 
-    if (IsOpenBracket(token)) {
-        to_ret = ReadList(tokenizer);
-    } else if (IsConstantToken(token)) {
-        to_ret = std::make_shared<Number>(GetConstantTokenValue(token));
-    } else if (IsQuoteToken(token)) {
-        auto str = "quote";
-        auto first = std::make_shared<Symbol>(str);
-        to_ret = std::make_shared<Cell>();
-        As<Cell>(to_ret)->GetFirst() = first;
-        tokenizer->Next();
-        auto argument = ReadImpl(tokenizer);
-        auto second_cell = std::make_shared<Cell>();
-        second_cell->GetFirst() = argument;
-        As<Cell>(to_ret)->GetSecond() = second_cell;
+// Builds datums out of tokens handed over one at a time. Keeps the open lists
+// and quotes on an explicit stack rather than recursing, so nesting depth is
+// bounded only by max_depth and never by the native stack.
+class DatumBuilder {
+public:
+    DatumBuilder(SymbolTable* symbols, Heap* heap, std::pmr::memory_resource* arena,
+                 size_t max_depth)
+        : symbols_(symbols), heap_(heap), arena_(arena), max_depth_(max_depth) {
+    }
 
-        return to_ret;
+    // Takes the current token of tokenizer and consumes it. Returns true and
+    // stores the datum if the token completes one at the top level.
+    bool Push(Tokenizer* tokenizer, Object** datum);
+
+    bool HasOpenDatum() const {
+        return !frames_.empty();
+    }
+
+private:
+    SymbolTable* symbols_;
+    Heap* heap_;
+    std::pmr::memory_resource* arena_;
+    size_t max_depth_;
+    std::vector<ReadFrame> frames_;
+};
+
+bool DatumBuilder::Push(Tokenizer* tokenizer, Object** datum) {
+    Object* value;
+    const auto& token = tokenizer->GetToken();
+    if (!frames_.empty() && !frames_.back().quote && IsCloseBracket(token)) {
+        auto& list = frames_.back().items;
+        // A misplaced dot is only found once the whole list is there.
+        if (HasMisplacedDot(list)) {
+            ThrowSyntaxError(tokenizer->GetPosition(), "Wrong Syntax");
+        }
+        if (list.empty()) {
+            value = nullptr;
+        } else if (frames_.back().data) {
+            value = MakeList(std::move(list), heap_, arena_);
+        } else {
+            value = ListASTFromVector(std::move(list), heap_, arena_);
+        }
+        if (value) {
+            value->SetSourceOffset(frames_.back().offset);
+        }
+        frames_.pop_back();
+    } else if (IsOpenBracket(token) || IsQuoteToken(token)) {
+        if (frames_.size() >= max_depth_) {
+            ThrowSyntaxError(tokenizer->GetPosition(), "Nesting too deep");
+        }
+        frames_.push_back(ReadFrame{IsQuoteToken(token), IsData(frames_),
+                                    IsSplicedTail(frames_), {},
+                                    tokenizer->GetPosition().offset});
+        tokenizer->Consume();
+        return false;
+    } else if (IsConstantToken(token)) {
+        auto digits = GetConstantTokenDigits(token);
+        if (digits.empty()) {
+            value = MakeNumber(heap_, GetConstantTokenValue(token));
+        } else {
+            value = MakeNumber(heap_, BigInt::FromString(digits));
+        }
     } else if (IsSymbolToken(token)) {
         auto str = GetSymbolTokenValue(token);
         if (str == "#t" || str == "#f") {
-            to_ret = std::make_shared<Bool>(str);
+            value = MakeBool(str == "#t");
         } else {
-            to_ret = std::make_shared<Symbol>(GetSymbolTokenValue(token));
+            value = symbols_->Intern(str);
         }
     } else if (IsDotToken(token)) {
-        to_ret = std::make_shared<Dot>();
+        value = MakeNode<Dot>(heap_, arena_);
     } else {
-        throw SyntaxError("Wrong Syntax");
+        ThrowSyntaxError(tokenizer->GetPosition(), "Wrong Syntax");
     }
-    tokenizer->Next();
-    return to_ret;
+    tokenizer->Consume();
+
+    while (!frames_.empty() && frames_.back().quote) {
+        value = MakeQuote(value, symbols_, heap_, arena_);
+        value->SetSourceOffset(frames_.back().offset);
+        frames_.pop_back();
+    }
+    if (frames_.empty()) {
+        *datum = value;
+        return true;
+    }
+    frames_.back().items.push_back(value);
+    return false;
+}
+
+// Hands the tokens of text to builder, appending the datums they complete.
+// Returns where text ends.
+SourcePosition PushTokens(std::string_view text, const SourcePosition& start,
+                          DatumBuilder* builder, std::vector<Object*>* datums) {
+    Tokenizer tokenizer{text, start};
+    while (!tokenizer.IsEnd()) {
+        Object* datum;
+        if (builder->Push(&tokenizer, &datum)) {
+            datums->push_back(datum);
+        }
+    }
+    return tokenizer.GetPosition();
 }
 
-#include <iostream>
+}  // namespace
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
-    auto to_ret = ReadImpl(tokenizer);
+Object* ReadImpl(Tokenizer* tokenizer, SymbolTable* symbols, Heap* heap,
+                 std::pmr::memory_resource* arena, size_t max_depth) {
+    DatumBuilder builder(symbols, heap, arena, max_depth);
+    while (true) {
+        Object* datum;
+        if (builder.Push(tokenizer, &datum)) {
+            return datum;
+        }
+    }
+}
+
+Object* ReadForm(Tokenizer* tokenizer, SymbolTable* symbols, Heap* heap,
+                 std::pmr::memory_resource* arena, size_t max_depth) {
+    return ReadImpl(tokenizer, symbols, heap, arena, max_depth);
+}
+
+Object* Read(Tokenizer* tokenizer, SymbolTable* symbols, Heap* heap,
+             std::pmr::memory_resource* arena, size_t max_depth) {
+    auto to_ret = ReadImpl(tokenizer, symbols, heap, arena, max_depth);
     if (!tokenizer->IsEnd()) {
-        throw SyntaxError("Wrong Syntax");
+        ThrowSyntaxError(tokenizer->GetPosition(), "Wrong Syntax");
     }
     return to_ret;
 }
+
+Object* Read(Tokenizer* tokenizer) {
+    static thread_local SymbolTable symbols;
+    static thread_local Heap heap;
+    return Read(tokenizer, &symbols, &heap);
+}
+
+struct PushReader::State {
+    DatumBuilder builder;
+};
+
+namespace {
+
+// Characters no number or symbol goes on past: spaces, and the tokens that
+// are a single character.
+constexpr std::string_view kTokenBreaks = " \n()'.";
+
+}  // namespace
+
+PushReader::PushReader(SymbolTable* symbols, Heap* heap, size_t max_depth)
+    : state_(std::make_unique<State>(DatumBuilder(symbols, heap, nullptr, max_depth))) {
+}
+
+PushReader::~PushReader() = default;
+
+void PushReader::Feed(std::string_view chunk, std::vector<Object*>* datums) {
+    if (!pending_.empty()) {
+        auto end = chunk.find_first_of(kTokenBreaks);
+        if (end == std::string_view::npos) {
+            pending_.append(chunk);
+            return;
+        }
+        pending_.append(chunk.substr(0, end));
+        position_ = PushTokens(pending_, position_, &state_->builder, datums);
+        pending_.clear();
+        chunk.remove_prefix(end);
+    }
+    auto end = chunk.find_last_of(kTokenBreaks);
+    end = end == std::string_view::npos ? 0 : end + 1;
+    position_ = PushTokens(chunk.substr(0, end), position_, &state_->builder, datums);
+    pending_.assign(chunk.substr(end));
+}
+
+void PushReader::Finish(std::vector<Object*>* datums) {
+    position_ = PushTokens(pending_, position_, &state_->builder, datums);
+    pending_.clear();
+    if (state_->builder.HasOpenDatum()) {
+        ThrowSyntaxError(position_, "Wrong Syntax");
+    }
+}
+
+bool PushReader::HasOpenDatum() const {
+    return state_->builder.HasOpenDatum();
+}
@@ -1,10 +1,83 @@
 #pragma once
 
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
 
+#include "heap.h"
 #include "object.h"
+#include "symbol_table.h"
 #include <tokenizer.h>
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+inline constexpr size_t kNoDepthLimit = std::numeric_limits<size_t>::max();
 
-std::shared_ptr<Object> ListASTFromVector(std::vector<std::shared_ptr<Object>> list);
\ No newline at end of file
+// Symbols are interned into the given table, so every occurrence of a
+// spelling shares one Symbol object. Fresh nodes are made on the heap.
+//
+// If an arena is given, fresh nodes are placed in it instead and are never
+// seen by the collector. The caller must drop every pointer into the result
+// before releasing the arena.
+//
+// Input nested more than max_depth lists and quotes deep is rejected with a
+// SyntaxError.
+Object* Read(Tokenizer* tokenizer, SymbolTable* symbols, Heap* heap,
+             std::pmr::memory_resource* arena = nullptr, size_t max_depth = kNoDepthLimit);
+
+// Reads into a per-thread heap that is never collected. Meant for tools and
+// tests that have no interpreter around.
+Object* Read(Tokenizer* tokenizer);
+
+// Reads one datum and leaves the tokenizer right after it, so consecutive
+// calls walk the top-level forms of a source. Nothing past the datum is read,
+// so a stream need not have more to give yet.
+Object* ReadForm(Tokenizer* tokenizer, SymbolTable* symbols, Heap* heap,
+                 std::pmr::memory_resource* arena = nullptr, size_t max_depth = kNoDepthLimit);
+
+// Reads datums out of input handed over in chunks of any size, e.g. as they
+// come off a socket. Each datum, and each SyntaxError, is the same as Read
+// would give for it. Of the input, only a token cut in two by the end of a
+// chunk is kept, so a stream of datums is read in memory bounded by the
+// largest of them.
+//
+// Datums are made on the heap. The parts of one still being read are
+// reachable only from the reader, so the heap must not collect while
+// HasOpenDatum is true. After a SyntaxError the reader is of no further use.
+class PushReader {
+public:
+    PushReader(SymbolTable* symbols, Heap* heap, size_t max_depth = kNoDepthLimit);
+    ~PushReader();
+
+    PushReader(const PushReader&) = delete;
+    PushReader& operator=(const PushReader&) = delete;
+
+    // Appends the datums chunk completes to datums, in order. A number or
+    // symbol at the end of chunk may go on in the next one, so it waits for
+    // that or for Finish.
+    void Feed(std::string_view chunk, std::vector<Object*>* datums);
+
+    // Ends the input, appending the datum its last token completes, if any.
+    // Input that ends inside a datum is a SyntaxError.
+    void Finish(std::vector<Object*>* datums);
+
+    bool HasOpenDatum() const;
+
+private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+    // The token the last chunk ended in, and where it starts.
+    std::string pending_;
+    SourcePosition position_;
+};
+
+Object* ListASTFromVector(std::vector<Object*> list, Heap* heap,
+                          std::pmr::memory_resource* arena = nullptr);
+
+// Like ListASTFromVector, but stores the elements as one List when it can:
+// a dotted tail that is itself a List is merged into it, and only a tail that
+// is a Cell makes it fall back to Cells.
+Object* MakeList(std::vector<Object*> list, Heap* heap,
+                 std::pmr::memory_resource* arena = nullptr);
@@ -0,0 +1,39 @@
+#include "printer.h"
+
+namespace {
+
+constexpr size_t kStreamChunkSize = 1 << 16;
+
+}  // namespace
+
+Printer::Printer(std::string* out) : out_(out) {
+}
+
+Printer::Printer(std::ostream* out) : stream_(out), out_(&buffer_) {
+    buffer_.reserve(kStreamChunkSize);
+}
+
+Printer::~Printer() {
+    Flush();
+}
+
+void Printer::Write(std::string_view text) {
+    out_->append(text);
+    if (stream_ && buffer_.size() >= kStreamChunkSize) {
+        Flush();
+    }
+}
+
+void Printer::Write(char c) {
+    out_->push_back(c);
+    if (stream_ && buffer_.size() >= kStreamChunkSize) {
+        Flush();
+    }
+}
+
+void Printer::Flush() {
+    if (stream_ && !buffer_.empty()) {
+        stream_->write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+}
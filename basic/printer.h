@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Sink for printed objects. Either appends to a caller's string, or collects
+// output in a small buffer that is handed to a stream whenever it fills up,
+// so a large result is never held in memory whole.
+class Printer {
+public:
+    explicit Printer(std::string* out);
+    explicit Printer(std::ostream* out);
+    ~Printer();
+
+    Printer(const Printer&) = delete;
+    Printer& operator=(const Printer&) = delete;
+
+    void Write(std::string_view text);
+    void Write(char c);
+
+    // Hands everything buffered so far to the stream, if there is one.
+    void Flush();
+
+private:
+    std::ostream* stream_ = nullptr;
+    std::string buffer_;
+    std::string* out_;
+};
@@ -0,0 +1,117 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "object.h"
+#include "tokenizer.h"
+
+namespace {
+
+// Calls the current thread is inside, outermost first. Shared by all
+// profilers: a thread evaluates with at most one at a time, except for work
+// it takes over from other threads, which runs under a SetAsideScope.
+thread_local std::vector<SamplingProfiler::Frame> call_stack;
+
+std::string DescribeCall(const SamplingProfiler::Frame& frame) {
+    auto head = frame.call->GetFirst();
+    std::string name = head && Is<Symbol>(head) ? As<Symbol>(head)->GetName() : "?";
+    auto offset = frame.call->GetSourceOffset();
+    if (!frame.source || offset == Object::kNoSourceOffset ||
+        offset >= frame.source->GetText().size()) {
+        return name;
+    }
+    return name + "@" + FormatSourcePosition(frame.source->Locate(offset));
+}
+
+}  // namespace
+
+SamplingProfiler::SamplingProfiler(std::chrono::microseconds interval)
+    : interval_(interval), timer_([this](std::stop_token stop) { TimerLoop(stop); }) {
+}
+
+SamplingProfiler::~SamplingProfiler() = default;
+
+void SamplingProfiler::RequestSample() {
+    due_.store(true, std::memory_order_relaxed);
+}
+
+size_t SamplingProfiler::GetSampleCount() const {
+    std::lock_guard lock(samples_mutex_);
+    return sample_count_;
+}
+
+std::string SamplingProfiler::GetFoldedStacks() const {
+    std::vector<std::pair<std::string, size_t>> stacks;
+    {
+        std::lock_guard lock(samples_mutex_);
+        stacks.assign(samples_.begin(), samples_.end());
+    }
+    std::sort(stacks.begin(), stacks.end());
+    std::string out;
+    for (const auto& [stack, count] : stacks) {
+        out += stack + " " + std::to_string(count) + "\n";
+    }
+    return out;
+}
+
+void SamplingProfiler::Reset() {
+    std::lock_guard lock(samples_mutex_);
+    samples_.clear();
+    sample_count_ = 0;
+}
+
+SamplingProfiler::SetAsideScope::SetAsideScope() {
+    saved_.swap(call_stack);
+}
+
+SamplingProfiler::SetAsideScope::~SetAsideScope() {
+    saved_.swap(call_stack);
+}
+
+void SamplingProfiler::Enter(Cell* call, LineIndex* source) {
+    if (call_stack.empty()) {
+        active_.fetch_add(1, std::memory_order_relaxed);
+    }
+    call_stack.push_back({call, source});
+    MaybeRecord();
+}
+
+void SamplingProfiler::Leave() {
+    MaybeRecord();
+    call_stack.pop_back();
+    if (call_stack.empty()) {
+        active_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void SamplingProfiler::MaybeRecord() {
+    if (due_.load(std::memory_order_relaxed) && due_.exchange(false, std::memory_order_relaxed)) {
+        Record();
+    }
+}
+
+void SamplingProfiler::Record() {
+    std::string stack;
+    for (const auto& frame : call_stack) {
+        if (!stack.empty()) {
+            stack += ';';
+        }
+        stack += DescribeCall(frame);
+    }
+    std::lock_guard lock(samples_mutex_);
+    ++samples_[stack];
+    ++sample_count_;
+}
+
+void SamplingProfiler::TimerLoop(std::stop_token stop) {
+    std::unique_lock lock(timer_mutex_);
+    while (!stop.stop_requested()) {
+        timer_wake_.wait_for(lock, stop, interval_, [] { return false; });
+        // A sample flagged while nothing runs would blame the idle time on
+        // whatever gets evaluated next.
+        if (active_.load(std::memory_order_relaxed) > 0) {
+            due_.store(true, std::memory_order_relaxed);
+        }
+    }
+}
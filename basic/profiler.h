@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Cell;
+class LineIndex;
+
+// Samples what the tree walker is evaluating. Every thread evaluating with a
+// profiler keeps a stack of the calls it is inside; a timer thread flags a
+// sample every interval, and the next evaluating thread to enter or leave a
+// call copies its stack into the profile. Recording happens on that thread,
+// while the calls are certainly alive, and only once per interval, so the
+// cost between samples is a push, a pop and a flag check per call.
+//
+// Samples land on call boundaries: time spent inside a long builtin counts
+// for the call when it returns.
+class SamplingProfiler {
+public:
+    explicit SamplingProfiler(std::chrono::microseconds interval = std::chrono::milliseconds(1));
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    // Makes the next call boundary record a sample, as if the interval had
+    // just passed.
+    void RequestSample();
+
+    size_t GetSampleCount() const;
+
+    // One line per distinct stack, outermost call first, the calls separated
+    // by ';' and followed by the number of samples: the folded format that
+    // flamegraph tools read. Lines are sorted. A call shows up as the name
+    // it calls and, if known, where it starts, as in "max@2:7".
+    std::string GetFoldedStacks() const;
+
+    void Reset();
+
+    // Keeps a call on the current thread's stack for as long as it lives.
+    // Does nothing for a nullptr profiler. source indexes the text the call
+    // was read from, if known.
+    class Scope {
+    public:
+        Scope(SamplingProfiler* profiler, Cell* call, LineIndex* source)
+            : profiler_(profiler) {
+            if (profiler_) {
+                profiler_->Enter(call, source);
+            }
+        }
+        ~Scope() {
+            if (profiler_) {
+                profiler_->Leave();
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SamplingProfiler* profiler_;
+    };
+
+    // A call on a thread's stack.
+    struct Frame {
+        Cell* call;
+        LineIndex* source;
+    };
+
+    // Sets the calls the current thread is inside aside while it lives, for
+    // work that is part of another thread's evaluation, e.g. a chunk a pool
+    // thread took over while waiting on its own. The work then starts on a
+    // stack of its own and is sampled by its own profiler only.
+    class SetAsideScope {
+    public:
+        SetAsideScope();
+        ~SetAsideScope();
+
+        SetAsideScope(const SetAsideScope&) = delete;
+        SetAsideScope& operator=(const SetAsideScope&) = delete;
+
+    private:
+        std::vector<Frame> saved_;
+    };
+
+private:
+    void Enter(Cell* call, LineIndex* source);
+    void Leave();
+    void MaybeRecord();
+    void Record();
+    void TimerLoop(std::stop_token stop);
+
+    std::chrono::microseconds interval_;
+    std::atomic<bool> due_ = false;
+    // Threads evaluating with this profiler.
+    std::atomic<size_t> active_ = 0;
+
+    mutable std::mutex samples_mutex_;
+    std::unordered_map<std::string, size_t> samples_;
+    size_t sample_count_ = 0;
+
+    std::mutex timer_mutex_;
+    std::condition_variable_any timer_wake_;
+    // Last, so that it stops before the rest goes away.
+    std::jthread timer_;
+};
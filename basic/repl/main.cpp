@@ -1,5 +1,78 @@
 #include <iostream>
+#include <string_view>
+#include <system_error>
 
-int main() {
+#include <unistd.h>
+
+#include <error.h>
+#include <mapped_file.h>
+#include <scheme.h>
+#include <tokenizer.h>
+
+// Usage: scheme_basic_repl [file...]
+//
+// Evaluates the top-level forms of the given files, or of stdin if there are
+// none, and prints one line per form: its result, or the error it raised.
+// Forms from stdin are read as the bytes arrive and each is evaluated as soon
+// as it is complete, with its line flushed right away, so the REPL can serve
+// as a co-process over a pipe. Prompts are only shown on a terminal.
+
+namespace {
+
+template <class Error>
+void PrintError(std::string_view kind, const Error& error, Printer* printer) {
+    printer->Write(kind);
+    printer->Write(": ");
+    printer->Write(error.what());
+}
+
+void RunForms(Interpreter* interpreter, Tokenizer* tokenizer, bool interactive) {
+    Printer printer(&std::cout);
+    while (true) {
+        if (interactive) {
+            std::cout << "> " << std::flush;
+        }
+        if (tokenizer->IsEnd()) {
+            break;
+        }
+        try {
+            interpreter->RunForm(tokenizer, &printer);
+        } catch (const SyntaxError& error) {
+            PrintError("SyntaxError", error, &printer);
+            // The rest of the form cannot be told apart from the next one.
+            tokenizer->SkipLine();
+        } catch (const NameError& error) {
+            PrintError("NameError", error, &printer);
+        } catch (const RuntimeError& error) {
+            PrintError("RuntimeError", error, &printer);
+        }
+        printer.Write('\n');
+        printer.Flush();
+        std::cout.flush();
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+    Interpreter interpreter;
+
+    if (argc < 2) {
+        Tokenizer tokenizer{&std::cin};
+        RunForms(&interpreter, &tokenizer, isatty(STDIN_FILENO));
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        try {
+            MappedFile file(argv[i]);
+            Tokenizer tokenizer{file.GetData()};
+            RunForms(&interpreter, &tokenizer, false);
+        } catch (const std::system_error& error) {
+            std::cerr << error.what() << '\n';
+            return 1;
+        }
+    }
     return 0;
 }
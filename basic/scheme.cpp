@@ -1,98 +1,261 @@
 #include "scheme.h"
-#include <sstream>
+#include "argument_stack.h"
 #include <tokenizer.h>
 #include <parser.h>
-#include <algorithm>
+#include "bytecode.h"
 #include "error.h"
+#include "heap.h"
+#include "instrumentation.h"
+#include "mapped_file.h"
+#include "parallel_eval.h"
+#include "printer.h"
 
-void CheckNullptr(std::shared_ptr<Object> ptr) {
-    if (ptr == nullptr) {
-        throw RuntimeError("Nullptr issue");
-    }
-}
+#include <charconv>
+
+namespace {
 
-template <typename T>
-void CheckIfValidTypes(std::vector<std::shared_ptr<Object>>& vec) {
-    for (auto elem : vec) {
-        if (!Is<T>(elem)) {
-            throw RuntimeError("Wrong Types");
+// Most requests fit into this much stack memory, so their nodes never touch
+// the heap at all.
+constexpr size_t kArenaInitialSize = 4096;
+
+// Times the phases of one request into stats, unless that is nullptr: then
+// every call is a single branch.
+class PhaseClock {
+public:
+    explicit PhaseClock(InterpreterStats* stats) : stats_(stats) {
+        if (stats_) {
+            start_ = last_ = std::chrono::steady_clock::now();
         }
     }
-}
 
-void CheckIfBadArgsCount(std::vector<std::shared_ptr<Object>>& vec, std::vector<size_t> bad_counts,
-                         std::vector<size_t> good_counts) {
-    if (!bad_counts.empty()) {
-        for (auto elem : bad_counts) {
-            if (vec.size() == elem) {
-                throw RuntimeError("Wrong Types");
-            }
+    // Adds the time since the previous lap to the phase.
+    void Lap(std::chrono::nanoseconds InterpreterStats::*phase) {
+        if (stats_) {
+            auto now = std::chrono::steady_clock::now();
+            stats_->*phase += now - last_;
+            last_ = now;
         }
-    } else {
-        bool fl = false;
-        for (auto elem : good_counts) {
-            if (vec.size() == elem) {
-                fl = true;
-            }
-        }
-        if (!fl) {
-            throw RuntimeError("Wrong Types");
+    }
+
+    // Counts the request as done.
+    void Finish() {
+        if (stats_) {
+            auto time = std::chrono::steady_clock::now() - start_;
+            ++stats_->requests;
+            stats_->request_time += time;
+            ++stats_->request_latency[GetLatencyBucket(time)];
         }
     }
+
+private:
+    InterpreterStats* stats_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+}  // namespace
+
+Interpreter::Interpreter(InterpreterOptions options)
+    : Interpreter(GlobalEnvironment::GetDefault(), options) {
 }
 
-std::vector<std::shared_ptr<Object>> ConvertToVector(std::shared_ptr<Object> cell) {
-    std::vector<std::shared_ptr<Object>> to_ret;
-    if (cell == nullptr) {
-        return to_ret;
+Interpreter::Interpreter(std::shared_ptr<const GlobalEnvironment> environment,
+                         InterpreterOptions options)
+    : options_(options), environment_(std::move(environment)) {
+    if (options_.parallel_threads > 1) {
+        pool_ = std::make_unique<WorkStealingPool>(options_.parallel_threads - 1);
     }
-    while (true) {
-        if (!Is<Cell>(cell)) {
-            throw RuntimeError("RE");
-        }
-        auto ptr_first = As<Cell>(cell)->GetFirst();
-        auto ptr_second = As<Cell>(cell)->GetSecond();
-        to_ret.push_back(ptr_first);
-        if (ptr_second == nullptr) {
-            break;
+    if (options_.instrument) {
+        calls_ = std::make_unique<CallCounters>(environment_->GetSymbols().Size());
+    }
+}
+
+std::string Interpreter::Run(const std::string& expr) {
+    std::string result;
+    Printer printer(&result);
+    Run(expr, &printer);
+    return result;
+}
+
+void Interpreter::Run(const std::string& expr, std::ostream* out) {
+    Printer printer(out);
+    Run(expr, &printer);
+}
+
+void Interpreter::Run(const std::string& expr, Printer* printer) {
+    PhaseClock clock(calls_ ? &stats_ : nullptr);
+    std::byte initial[kArenaInitialSize];
+    std::pmr::monotonic_buffer_resource arena(initial, sizeof(initial));
+
+    auto cached = cache_.Find(expr);
+    Object* input_ast = nullptr;
+    if (!cached) {
+        Tokenizer tokenizer{std::string_view(expr)};
+        if (cache_.Accepts(expr)) {
+            input_ast = Read(&tokenizer, &symbols_, &heap_, nullptr, options_.max_depth);
+            cached = cache_.Insert(expr, input_ast);
+        } else {
+            input_ast = Read(&tokenizer, &symbols_, &heap_,
+                             options_.use_arena ? &arena : nullptr, options_.max_depth);
         }
-        if (Is<Number>(ptr_second)) {
-            to_ret.push_back(ptr_second);
-            break;
+    }
+    clock.Lap(&InterpreterStats::read_time);
+
+    LineIndex source(expr);
+    auto result = cached ? Eval(cached, &source) : Eval(input_ast, &source);
+    clock.Lap(&InterpreterStats::eval_time);
+
+    result->Print(printer);
+    clock.Lap(&InterpreterStats::print_time);
+
+    heap_.MaybeCollect();
+    clock.Finish();
+}
+
+void Interpreter::RunFile(const std::string& path, std::ostream* out) {
+    MappedFile file(path);
+    Tokenizer tokenizer{file.GetData()};
+    // Shared by the forms, so that the file is gone through only once when
+    // positions are needed.
+    LineIndex source(file.GetData());
+    Printer printer(out);
+    while (!tokenizer.IsEnd()) {
+        RunForm(&tokenizer, &source, &printer);
+        printer.Write('\n');
+    }
+}
+
+void Interpreter::RunForm(Tokenizer* tokenizer, Printer* printer) {
+    RunForm(tokenizer, nullptr, printer);
+}
+
+void Interpreter::RunForm(Tokenizer* tokenizer, LineIndex* source, Printer* printer) {
+    PhaseClock clock(calls_ ? &stats_ : nullptr);
+    {
+        std::byte initial[kArenaInitialSize];
+        std::pmr::monotonic_buffer_resource arena(initial, sizeof(initial));
+        auto input_ast = ReadForm(tokenizer, &symbols_, &heap_,
+                                  options_.use_arena ? &arena : nullptr, options_.max_depth);
+        clock.Lap(&InterpreterStats::read_time);
+        auto result = Eval(input_ast, source);
+        clock.Lap(&InterpreterStats::eval_time);
+        result->Print(printer);
+        clock.Lap(&InterpreterStats::print_time);
+    }
+    heap_.MaybeCollect();
+    clock.Finish();
+}
+
+const HeapStats& Interpreter::GetHeapStats() const {
+    return heap_.GetStats();
+}
+
+InterpreterStats Interpreter::GetStats() const {
+    auto stats = stats_;
+    const auto& builtin_symbols = environment_->GetSymbols();
+    if (calls_) {
+        for (size_t id = 0; id < builtin_symbols.Size(); ++id) {
+            auto function = builtins_.TryFind(*builtin_symbols.Get(id));
+            if (function && calls_->GetCalls(id) > 0) {
+                stats.builtins.push_back(
+                    {function->GetName(), calls_->GetCalls(id), calls_->GetTime(id)});
+            }
         }
-        cell = ptr_second;
     }
-    return to_ret;
+    const auto& heap_stats = heap_.GetStats();
+    for (size_t i = 0; i < kObjectTypeCount; ++i) {
+        stats.objects_made[i] = heap_stats.objects_made[i] + heap_stats.arena_objects_made[i];
+    }
+    stats.objects_made[static_cast<size_t>(ObjectType::kSymbol)] =
+        symbols_.Size() - builtin_symbols.Size();
+    return stats;
 }
 
-std::string Interpreter::Run(const std::string& expr) {
-    std::stringstream ss(expr);
-    Tokenizer tokenizer(&ss);
+const ExpressionCacheStats& Interpreter::GetCacheStats() const {
+    return cache_.GetStats();
+}
 
-    auto input_ast = Read(&tokenizer);
+void Interpreter::ClearCache() {
+    cache_.Clear();
+}
 
-    CheckNullptr(input_ast);
-    auto output_ast = input_ast->Eval();
+void Interpreter::SetCacheCapacity(size_t capacity) {
+    cache_.SetCapacity(capacity);
+}
 
-    return output_ast->Serialize();
+Object* Interpreter::Eval(Object* ast, LineIndex* source) {
+    CheckNullptr(ast);
+    if (options_.use_bytecode) {
+        return Execute(Compile(ast, builtins_));
+    }
+    auto context = MakeContext(source);
+    auto output_ast = ast->Eval(&context);
+    CheckNullptr(output_ast);
+    return output_ast;
 }
 
-std::shared_ptr<Object> Number::Eval() {
-    return std::make_shared<Number>(value_);
+Object* Interpreter::Eval(ExpressionCache::Entry* entry, LineIndex* source) {
+    if (!options_.use_bytecode) {
+        return Eval(entry->ast, source);
+    }
+    CheckNullptr(entry->ast);
+    if (!entry->program) {
+        entry->program = Compile(entry->ast, builtins_);
+    }
+    return Execute(*entry->program);
+}
+
+Object* Interpreter::Execute(const Program& program) {
+    auto context = MakeContext(nullptr);
+    auto output_ast = ::Execute(program, &context);
+    CheckNullptr(output_ast);
+    return output_ast;
+}
+
+Context Interpreter::MakeContext(LineIndex* source) {
+    return Context{.builtins = &builtins_,
+                   .heap = &heap_,
+                   .arguments = &arguments_,
+                   .pool = pool_.get(),
+                   .shared_pool = options_.parallel_threads == 0,
+                   .parallel_min_args = options_.parallel_min_args,
+                   .calls = calls_.get(),
+                   .profiler = options_.profiler,
+                   .source = source};
+}
+
+void Object::Print(Printer* printer) {
+    printer->Write(Serialize());
+}
+
+Object* Number::Eval(Context*) {
+    return this;
 }
 std::string Number::Serialize() {
-    return std::to_string(GetValue());
+    return IsBig() ? big_->ToString() : std::to_string(GetValue());
+}
+void Number::Print(Printer* printer) {
+    if (IsBig()) {
+        printer->Write(big_->ToString());
+        return;
+    }
+    char buffer[24];
+    auto end = std::to_chars(std::begin(buffer), std::end(buffer), GetValue()).ptr;
+    printer->Write(std::string_view(buffer, end - buffer));
 }
 
-std::shared_ptr<Object> Symbol::Eval() {
-    return std::make_shared<Function>(name_);
+Object* Symbol::Eval(Context* context) {
+    return context->builtins->Find(*this);
 }
 std::string Symbol::Serialize() {
     return GetName();
 }
+void Symbol::Print(Printer* printer) {
+    printer->Write(GetName());
+}
 
-std::shared_ptr<Object> Bool::Eval() {
-    return std::make_shared<Bool>(GetBool());
+Object* Bool::Eval(Context*) {
+    return this;
 }
 std::string Bool::Serialize() {
     if (GetBool()) {
@@ -102,445 +265,234 @@ std::string Bool::Serialize() {
     }
 }
 
-std::vector<std::shared_ptr<Object>> EvalVector(std::vector<std::shared_ptr<Object>>& args) {
-    std::vector<std::shared_ptr<Object>> to_ret;
-    for (auto elem : args) {
-        CheckNullptr(elem);
-        to_ret.push_back(elem->Eval());
-    }
-    return to_ret;
-}
-
-Function::Function(std::string name) {
-    if (name == "quote") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) { return nullptr; };
-    } /*NUMBER FUNCTIONS*/ else if (name == "number?") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            std::shared_ptr<Object> to_ret;
-            to_ret = std::make_shared<Bool>(Is<Number>(args.front()));
-            return to_ret;
-        };
-    } else if (name == "=") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = true;
-            if (!args.empty()) {
-                for (size_t i = 0; i < args.size() - 1; ++i) {
-                    if (As<Number>(args[i])->GetValue() == As<Number>(args[i + 1])->GetValue()) {
-
-                    } else {
-                        res = false;
-                    }
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == ">") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = true;
-            if (!args.empty()) {
-                for (size_t i = 0; i < args.size() - 1; ++i) {
-                    if (As<Number>(args[i])->GetValue() > As<Number>(args[i + 1])->GetValue()) {
-
-                    } else {
-                        res = false;
-                    }
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "<") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = true;
-            if (!args.empty()) {
-                for (size_t i = 0; i < args.size() - 1; ++i) {
-                    if (As<Number>(args[i])->GetValue() < As<Number>(args[i + 1])->GetValue()) {
-
-                    } else {
-                        res = false;
-                    }
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "<=") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = true;
-            if (!args.empty()) {
-                for (size_t i = 0; i < args.size() - 1; ++i) {
-                    if (As<Number>(args[i])->GetValue() <= As<Number>(args[i + 1])->GetValue()) {
-
-                    } else {
-                        res = false;
-                    }
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == ">=") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = true;
-            if (!args.empty()) {
-                for (size_t i = 0; i < args.size() - 1; ++i) {
-                    if (As<Number>(args[i])->GetValue() >= As<Number>(args[i + 1])->GetValue()) {
-
-                    } else {
-                        res = false;
-                    }
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "+") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            int64_t res = 0;
-            for (size_t i = 0; i < args.size(); ++i) {
-                res += As<Number>(args[i])->GetValue();
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "*") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            std::shared_ptr<Object> to_ret;
-            int64_t res = 1;
-            for (size_t i = 0; i < args.size(); ++i) {
-                res *= As<Number>(args[i])->GetValue();
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "-") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            CheckIfBadArgsCount(args, {0}, {});
-            std::shared_ptr<Object> to_ret;
-            int64_t res = As<Number>(args[0])->GetValue();
-            for (size_t i = 1; i < args.size(); ++i) {
-                res -= As<Number>(args[i])->GetValue();
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "/") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            CheckIfBadArgsCount(args, {0}, {});
-            std::shared_ptr<Object> to_ret;
-            int64_t res = As<Number>(args[0])->GetValue();
-            for (size_t i = 1; i < args.size(); ++i) {
-                res /= As<Number>(args[i])->GetValue();
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "max") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            CheckIfBadArgsCount(args, {0}, {});
-            std::shared_ptr<Object> to_ret;
-            int64_t res = As<Number>(args[0])->GetValue();
-            for (size_t i = 1; i < args.size(); ++i) {
-                int64_t cur_val = As<Number>(args[i])->GetValue();
-                res = std::max(res, cur_val);
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "min") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            CheckIfBadArgsCount(args, {0}, {});
-            std::shared_ptr<Object> to_ret;
-            int64_t res = As<Number>(args[0])->GetValue();
-            for (size_t i = 1; i < args.size(); ++i) {
-                int64_t cur_val = As<Number>(args[i])->GetValue();
-                res = std::min(res, cur_val);
-            }
-            to_ret = std::make_shared<Number>(res);
-            return to_ret;
-        };
-    } else if (name == "abs") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfValidTypes<Number>(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            std::shared_ptr<Object> to_ret;
-            to_ret = std::make_shared<Number>(std::abs(As<Number>(args.front())->GetValue()));
-            return to_ret;
-        };
-    } /*BOOLEAN FUNCTIONS*/ else if (name == "boolean?") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            std::shared_ptr<Object> to_ret;
-            to_ret = std::make_shared<Bool>(Is<Bool>(args.front()));
-            return to_ret;
-        };
-    } else if (name == "not") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            std::shared_ptr<Object> to_ret;
-            bool value = false;
-            if (Is<Bool>(args.front())) {
-                value = !As<Bool>(args.front())->GetBool();
-            }
-            to_ret = std::make_shared<Bool>(value);
-            return to_ret;
-        };
-    } else if (name == "and") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            std::shared_ptr<Object> to_ret = std::make_shared<Bool>(true);
-            for (auto elem : args) {
-                auto evaluated = elem->Eval();
-                if (Is<Bool>(evaluated) && !As<Bool>(evaluated)->GetBool()) {
-                    to_ret = evaluated;
-                    break;
-                }
-                to_ret = evaluated;
-            }
-            return to_ret;
-        };
-    } else if (name == "or") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            std::shared_ptr<Object> to_ret = std::make_shared<Bool>(false);
-            for (auto elem : args) {
-                auto evaluated = elem->Eval();
-                if (Is<Bool>(evaluated) && !As<Bool>(evaluated)->GetBool()) {
-                } else {
-                    to_ret = evaluated;
-                    break;
-                }
-            }
-            return to_ret;
-        };
-    } /*LIST OPERATIONS*/ else if (name == "pair?") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            CheckIfValidTypes<Cell>(args);
-            std::shared_ptr<Object> to_ret;
-            auto temp = ConvertToVector(As<Cell>(args.front())->GetFirst());
-            bool res = false;
-            if (temp.size() == 2) {
-                res = true;
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "null?") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            CheckIfValidTypes<Cell>(args);
-            std::shared_ptr<Object> to_ret;
-            auto temp = As<Cell>(args.front());
-            bool res = false;
-            if (temp->GetFirst() == nullptr && temp->GetSecond() == nullptr) {
-                res = true;
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "list?") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            CheckIfValidTypes<Cell>(args);
-            std::shared_ptr<Object> to_ret;
-            bool res = false;
-            auto cell = As<Cell>(args.front())->GetFirst();
-            if (cell == nullptr) {
-                res = true;
-            } else {
-                while (true) {
-                    auto ptr_first = As<Cell>(cell)->GetFirst();
-                    auto ptr_second = As<Cell>(cell)->GetSecond();
-                    if (ptr_second == nullptr) {
-                        res = true;
-                        break;
-                    }
-                    if (Is<Number>(ptr_second)) {
-                        break;
-                    }
-                    cell = ptr_second;
-                }
-            }
-            to_ret = std::make_shared<Bool>(res);
-            return to_ret;
-        };
-    } else if (name == "cons") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            CheckIfBadArgsCount(args, {}, {2});
-            std::shared_ptr<Object> to_ret;
-            auto dot = std::make_shared<Dot>();
-            args.insert(++args.begin(), dot);
-            return ListASTFromVector(args);
-        };
-    } else if (name == "car") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            CheckIfValidTypes<Cell>(args);
-            args = ConvertToVector(As<Cell>(args.front())->GetFirst());
-            CheckIfBadArgsCount(args, {0}, {});
-            std::shared_ptr<Object> to_ret = args.front();
-            return to_ret;
-        };
-    } else if (name == "cdr") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {1});
-            CheckIfValidTypes<Cell>(args);
-            std::shared_ptr<Object> to_ret;
-            auto temp_vec = ConvertToVector(As<Cell>(args.front())->GetFirst());
-            CheckIfBadArgsCount(temp_vec, {0}, {});
-            if (temp_vec.size() == 1) {
-                to_ret = std::make_shared<Cell>();
-                return to_ret;
-            }
-            if (temp_vec.size() >= 2) {
-                auto temp = As<Cell>(As<Cell>(args.front())->GetFirst())->GetSecond();
-                if (Is<Number>(temp)) {
-                    return temp;
-                } else {
-                    to_ret = std::make_shared<Cell>();
-                    As<Cell>(to_ret)->GetFirst() = temp;
-                    return to_ret;
-                }
-            }
-        };
-    } else if (name == "list") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            std::shared_ptr<Object> to_ret;
-            return ListASTFromVector(args);
-        };
-    } else if (name == "list-ref") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {2});
-            if (!Is<Cell>(args.front()) || !Is<Number>(args.back())) {
-                throw RuntimeError("Wrong types");
-            }
-            int ind = As<Number>(args.back())->GetValue();
-            auto list_vec = ConvertToVector(As<Cell>(args.front())->GetFirst());
-            if (ind >= list_vec.size() || ind < 0) {
-                throw RuntimeError("Index error");
-            }
-            std::shared_ptr<Object> to_ret;
-            auto cell = As<Cell>(args.front())->GetFirst();
-            auto ans = args.front();
-            for (int i = 0; i < ind + 1; ++i) {
-                auto ptr_first = As<Cell>(cell)->GetFirst();
-                auto ptr_second = As<Cell>(cell)->GetSecond();
-                ans = ptr_first;
-                cell = ptr_second;
-            }
-            return ans;
-        };
-    } else if (name == "list-tail") {
-        func_ = [](std::vector<std::shared_ptr<Object>>& args) {
-            std::shared_ptr<Object> to_ret;
-            args = EvalVector(args);
-            CheckIfBadArgsCount(args, {}, {2});
-            if (!Is<Cell>(args.front()) || !Is<Number>(args.back())) {
-                throw RuntimeError("Wrong types");
-            }
-            int ind = As<Number>(args.back())->GetValue();
-            auto list_vec = ConvertToVector(As<Cell>(args.front())->GetFirst());
-            if (ind > list_vec.size() || ind < 0) {
-                throw RuntimeError("Index error");
-            }
-            if (ind == list_vec.size()) {
-                to_ret = std::make_shared<Cell>();
-                return to_ret;
-            }
-            auto cell = As<Cell>(args.front())->GetFirst();
-            auto ans = As<Cell>(args.front())->GetFirst();
-            for (int i = 0; i < ind; ++i) {
-                auto ptr_first = As<Cell>(cell)->GetFirst();
-                auto ptr_second = As<Cell>(cell)->GetSecond();
-                cell = ptr_second;
-            }
-            return cell;
-        };
-    } else {
-        throw RuntimeError("Unknown Function");
-    }
+Function::Function(std::string name, size_t id, Impl impl, bool special_form)
+    : Object(kType), name_(std::move(name)), id_(id), func_(impl), special_form_(special_form) {
+}
+const std::string& Function::GetName() const {
+    return name_;
+}
+size_t Function::GetId() const {
+    return id_;
+}
+bool Function::IsSpecialForm() const {
+    return special_form_;
 }
 std::string Function::Serialize() {
     return "";
 }
-std::shared_ptr<Object> Function::Apply(std::vector<std::shared_ptr<Object>> args) {
-    return func_(args);
+Object* Function::Apply(Context* context, Args args) {
+    if (!context->calls) {
+        return func_(context, args);
+    }
+    CallCounters::Scope scope(context->calls, id_);
+    return func_(context, args);
 }
-std::shared_ptr<Object> Function::Eval() {
+Object* Function::Eval(Context*) {
     return nullptr;
 }
 
-std::shared_ptr<Object> Cell::Eval() {
-    if (!Is<Symbol>(GetFirst())) {
+namespace {
+
+// The operands of a call written as a chain of Cells.
+struct CellOperands {
+    Object* rest;
+
+    size_t Count() const {
+        return CountElements(rest);
+    }
+    template <class F>
+    void ForEach(F&& f) const {
+        ForEachElement(rest, f);
+    }
+    Object* Quote(Heap*) const {
+        return rest;
+    }
+};
+
+// The operands of a call held by a List: its elements after the first, then
+// its tail, walked as if the List were the Cell chain it stands for.
+struct ListOperands {
+    List* call;
+
+    size_t Count() const {
+        auto tail = call->GetTail();
+        if (tail == nullptr) {
+            return call->Size() - 1;
+        }
+        if (call->Size() == 1 || !Is<Number>(tail)) {
+            throw RuntimeError("RE");
+        }
+        return call->Size();
+    }
+    template <class F>
+    void ForEach(F&& f) const {
+        for (size_t i = 1; i < call->Size(); ++i) {
+            f(call->At(i));
+        }
+        if (call->GetTail() != nullptr) {
+            f(call->GetTail());
+        }
+    }
+    Object* Quote(Heap* heap) const {
+        return call->Size() > 1 ? call->Suffix(1, heap) : call->GetTail();
+    }
+};
+
+template <class Operands>
+Object* EvalCall(Context* context, Object* head, const Operands& operands) {
+    if (!Is<Symbol>(head)) {
         throw RuntimeError("Wrong Function");
     }
-    auto function = GetFirst()->Eval();
+    auto function = As<Function>(head->Eval(context));
 
-    if (As<Symbol>(GetFirst())->GetName() != "quote") {
-        auto args = ConvertToVector(GetSecond());
-        return As<Function>(function)->Apply(args);
+    if (As<Symbol>(head)->GetId() == SymbolTable::kQuote) {
+        return operands.Quote(context->heap);
     }
-    return GetSecond();
+
+    // The shape of the whole argument list is checked before any argument is
+    // evaluated; the arguments are then evaluated in place.
+    ArgumentStack::Frame frame(context->arguments, operands.Count());
+    auto args = frame.GetArgs();
+    size_t i = 0;
+    operands.ForEach([&](Object* arg) { args[i++] = arg; });
+    if (function->IsSpecialForm()) {
+        return function->Apply(context, args);
+    }
+    if (context->parallel_min_args > 0 && args.size() >= context->parallel_min_args) {
+        ParallelEval(context, args, 1, [args](size_t i, Context* context) {
+            CheckNullptr(args[i]);
+            return args[i]->Eval(context);
+        });
+    } else {
+        for (auto& arg : args) {
+            CheckNullptr(arg);
+            arg = arg->Eval(context);
+        }
+    }
+    return function->Apply(context, args);
 }
-std::string Cell::Serialize() {
-    std::string first;
-    std::string second;
-    if (GetFirst()) {
-        first = GetFirst()->Serialize();
-        if (Is<Cell>(GetFirst()) && first.size() != 2) {
-            first = first.substr(1, first.size() - 2);
+
+}  // namespace
+
+Object* Cell::Eval(Context* context) {
+    SamplingProfiler::Scope scope(context->profiler, this, context->source);
+    return EvalCall(context, GetFirst(), CellOperands{GetSecond()});
+}
+namespace {
+
+// Whether a list prints as "()": it holds nothing, or only a function,
+// which prints as nothing.
+bool PrintsEmpty(Object* list) {
+    if (Is<List>(list)) {
+        auto first = As<List>(list)->At(0);
+        return As<List>(list)->Size() == 1 && As<List>(list)->GetTail() == nullptr &&
+               (first == nullptr || Is<Function>(first));
+    }
+    auto first = As<Cell>(list)->GetFirst();
+    return As<Cell>(list)->GetSecond() == nullptr && (first == nullptr || Is<Function>(first));
+}
+
+// An element of a Cell chain or a List.
+struct Position {
+    Object* list;
+    size_t index;
+
+    Object* GetElement() const {
+        return Is<List>(list) ? As<List>(list)->At(index) : As<Cell>(list)->GetFirst();
+    }
+
+    // Moves on to the next element, or returns false and stores the tail
+    // that ends the list.
+    bool Advance(Object** tail) {
+        if (Is<List>(list)) {
+            if (++index < As<List>(list)->Size()) {
+                return true;
+            }
+            *tail = As<List>(list)->GetTail();
+            return false;
         }
+        auto second = As<Cell>(list)->GetSecond();
+        if (IsPair(second)) {
+            *this = Position{second, 0};
+            return true;
+        }
+        *tail = second;
+        return false;
     }
-    if (GetSecond()) {
-        second = GetSecond()->Serialize();
-        if (Is<Cell>(GetSecond())) {
-            second = second.substr(1, second.size() - 2);
-        } else {
-            second = ". " + second;
+};
+
+// Nested lists in car position print without their own brackets unless they
+// are empty, and a list in cdr position continues the enclosing one. Walks
+// both directions with an explicit stack, so neither long nor deep lists
+// recurse, and every piece goes straight to the printer.
+void PrintList(Object* list, Printer* printer) {
+    printer->Write('(');
+    // Positions whose element is being printed and whose rest is still due.
+    std::vector<Position> rest;
+    Position position{list, 0};
+    while (true) {
+        auto first = position.GetElement();
+        if (IsPair(first) && !PrintsEmpty(first)) {
+            rest.push_back(position);
+            position = Position{first, 0};
+            continue;
+        }
+        if (IsPair(first)) {
+            printer->Write("()");
+        } else if (first) {
+            first->Print(printer);
+        }
+
+        while (true) {
+            Object* tail;
+            if (position.Advance(&tail)) {
+                printer->Write(' ');
+                break;
+            }
+            if (tail) {
+                printer->Write(" . ");
+                tail->Print(printer);
+            }
+            if (rest.empty()) {
+                printer->Write(')');
+                return;
+            }
+            position = rest.back();
+            rest.pop_back();
         }
-        second = " " + second;
     }
-    return "(" + first + second + ")";
 }
 
-std::shared_ptr<Object> Dot::Eval() {
+}  // namespace
+
+std::string Cell::Serialize() {
+    std::string out;
+    Printer printer(&out);
+    Print(&printer);
+    return out;
+}
+
+void Cell::Print(Printer* printer) {
+    PrintList(this, printer);
+}
+
+// The reader stores only quoted lists as Lists, so code never holds one and
+// neither the bytecode compiler nor the profiler expects one; this is what
+// evaluating one as a call anyway amounts to.
+Object* List::Eval(Context* context) {
+    return EvalCall(context, At(0), ListOperands{this});
+}
+std::string List::Serialize() {
+    std::string out;
+    Printer printer(&out);
+    Print(&printer);
+    return out;
+}
+void List::Print(Printer* printer) {
+    PrintList(this, printer);
+}
+
+Object* Dot::Eval(Context*) {
     throw RuntimeError("Weird, bro!");
     return nullptr;
 }
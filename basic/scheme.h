@@ -1,8 +1,137 @@
 #pragma once
 
+#include <memory>
+#include <ostream>
 #include <string>
 
+#include "argument_stack.h"
+#include "builtins.h"
+#include "expression_cache.h"
+#include "global_environment.h"
+#include "heap.h"
+#include "instrumentation.h"
+#include "printer.h"
+#include "profiler.h"
+#include "tokenizer.h"
+#include "work_stealing_pool.h"
+
+struct InterpreterOptions {
+    // Parse each request into a bump arena that is released in one shot once
+    // the request is done, instead of allocating every node on the heap.
+    bool use_arena = true;
+
+    // Compile each expression to bytecode and run it on a stack VM instead of
+    // walking the AST.
+    bool use_bytecode = false;
+
+    // How many distinct requests Run keeps parsed (and compiled) for reuse;
+    // 0 turns the cache off. Cached requests are parsed onto the heap even
+    // when use_arena is set.
+    size_t cache_capacity = 1024;
+    // Longer requests are never cached, so the cache holds at most
+    // cache_capacity times this many bytes of text; they are parsed as if
+    // the cache were off.
+    size_t cache_max_request_size = 4096;
+
+    // Deepest nesting of lists and quotes a request may have; deeper input is
+    // a SyntaxError. Evaluation recurses along the same nesting, so this also
+    // bounds how much native stack an evaluation can take.
+    size_t max_depth = 1000;
+
+    // Threads parallel-map (and parallel argument evaluation) may use, the
+    // calling one included: 0 shares a pool of one per hardware thread with
+    // every other interpreter, started the first time any of them has work
+    // to split; 1 runs everything on the calling thread.
+    size_t parallel_threads = 0;
+
+    // Calls with at least this many arguments evaluate them concurrently
+    // instead of left to right; 0 turns this off. Builtins have no side
+    // effects, so the results are the same, and when several arguments fail
+    // the leftmost one's error is still the one raised. Only the tree walker
+    // does this.
+    size_t parallel_min_args = 0;
+
+    // Count calls and time of every builtin and time every phase of a
+    // request, see GetStats. Off, it costs a branch per builtin call and per
+    // phase.
+    bool instrument = false;
+
+    // Records samples of the calls the tree walker is inside. The profiler
+    // is the caller's, and may be shared by several interpreters; it must
+    // outlive this one.
+    SamplingProfiler* profiler = nullptr;
+
+    HeapOptions heap;
+};
+
+// A session evaluating requests against a GlobalEnvironment. The session
+// holds only what evaluation changes: its heap, the symbols its requests
+// added, its argument stack and its cache. It is cheap to make, and must be
+// used by one thread at a time; sessions sharing an environment can run on
+// different threads at once.
+//
+// Symbols a session's requests introduce are kept for the session's lifetime:
+// ids must stay valid for whatever still holds them, so neither ClearCache
+// nor anything else gives them back. A long-lived session fed ever new names
+// grows by one symbol per name; make a fresh session to start over.
 class Interpreter {
 public:
+    // Sessions on GlobalEnvironment::GetDefault().
+    Interpreter() = default;
+    explicit Interpreter(InterpreterOptions options);
+
+    explicit Interpreter(std::shared_ptr<const GlobalEnvironment> environment,
+                         InterpreterOptions options = {});
+
     std::string Run(const std::string& ast);
+
+    // Writes the result to out piece by piece instead of building it as one
+    // string first.
+    void Run(const std::string& ast, std::ostream* out);
+
+    // Maps the file into memory and evaluates its top-level forms one after
+    // another, writing each result to out on its own line.
+    void RunFile(const std::string& path, std::ostream* out);
+
+    // Reads the next top-level form from tokenizer, evaluates it and writes
+    // the result to printer. The tokenizer is left right after the form and
+    // has read nothing beyond it, so a session can follow a stream that is
+    // still being written, one form at a time.
+    void RunForm(Tokenizer* tokenizer, Printer* printer);
+
+    const HeapStats& GetHeapStats() const;
+
+    // Counts of objects made are always kept; everything else is only with
+    // InterpreterOptions::instrument set.
+    InterpreterStats GetStats() const;
+
+    const ExpressionCacheStats& GetCacheStats() const;
+    void ClearCache();
+    void SetCacheCapacity(size_t capacity);
+
+private:
+    void Run(const std::string& ast, Printer* printer);
+    // source indexes the text the tokenizer reads, if it has it whole.
+    void RunForm(Tokenizer* tokenizer, LineIndex* source, Printer* printer);
+
+    // source indexes the text the AST was read from, if known.
+    Object* Eval(Object* ast, LineIndex* source);
+    Object* Eval(ExpressionCache::Entry* entry, LineIndex* source);
+    Object* Execute(const Program& program);
+    Context MakeContext(LineIndex* source);
+
+    InterpreterOptions options_;
+    std::shared_ptr<const GlobalEnvironment> environment_ = GlobalEnvironment::GetDefault();
+
+    Heap heap_{options_.heap};
+    SymbolTable symbols_{&environment_->GetSymbols()};
+    const Builtins& builtins_ = environment_->GetBuiltins();
+    ArgumentStack arguments_;
+    ExpressionCache cache_{&heap_, options_.cache_capacity, options_.cache_max_request_size};
+    // Only made for a parallel_threads above 1.
+    std::unique_ptr<WorkStealingPool> pool_;
+    // Only made with instrumentation on. The builtin and object counts of
+    // stats_ are filled in by GetStats.
+    std::unique_ptr<CallCounters> calls_;
+    InterpreterStats stats_;
 };
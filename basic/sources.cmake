@@ -2,6 +2,22 @@ add_library(scheme_basic
     tokenizer.cpp
     parser.cpp
     scheme.cpp
+    builtins.cpp
+    symbol_table.cpp
+    global_environment.cpp
+    big_int.cpp
+    mapped_file.cpp
+    heap.cpp
+    bytecode.cpp
+    expression_cache.cpp
+    printer.cpp
+    argument_stack.cpp
+    numeric_kernels.cpp
+    batch.cpp
+    work_stealing_pool.cpp
+    parallel_eval.cpp
+    instrumentation.cpp
+    profiler.cpp
     
     # maybe more .cpp files here
 )
@@ -0,0 +1,42 @@
+#include "symbol_table.h"
+
+SymbolTable::SymbolTable(const SymbolTable* parent)
+    : parent_(parent), first_id_(parent ? parent->Size() : 0) {
+    if (!parent_) {
+        Intern("quote");
+    }
+}
+
+Symbol* SymbolTable::Intern(std::string_view name) {
+    if (auto symbol = Find(name)) {
+        return symbol;
+    }
+    size_t id = first_id_ + symbols_.size();
+    symbols_.push_back(std::make_unique<Symbol>(std::string(name), id));
+    ids_.emplace(symbols_.back()->GetName(), id);
+    return symbols_.back().get();
+}
+
+Symbol* SymbolTable::Find(std::string_view name) const {
+    if (parent_) {
+        if (auto symbol = parent_->Find(name)) {
+            return symbol;
+        }
+    }
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return nullptr;
+    }
+    return symbols_[it->second - first_id_].get();
+}
+
+Symbol* SymbolTable::Get(size_t id) const {
+    if (id < first_id_) {
+        return parent_->Get(id);
+    }
+    return symbols_[id - first_id_].get();
+}
+
+size_t SymbolTable::Size() const {
+    return first_id_ + symbols_.size();
+}
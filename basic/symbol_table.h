@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "object.h"
+
+// Hands out one canonical Symbol per spelling. Ids are dense and stable for
+// the lifetime of the table, so they can index per-symbol tables.
+//
+// A table may extend a parent that no longer changes, like a session's table
+// on top of the global one: names the parent knows resolve to its symbols,
+// and new names get ids following the parent's. Reading the parent takes no
+// locks, so any number of tables on any threads may share it.
+class SymbolTable {
+public:
+    static constexpr size_t kQuote = 0;
+
+    explicit SymbolTable(const SymbolTable* parent = nullptr);
+
+    // Symbols are never removed, so a table grows with every new name
+    // interned into it.
+    Symbol* Intern(std::string_view name);
+
+    // The symbol of a name that was interned before, else nullptr.
+    Symbol* Find(std::string_view name) const;
+
+    Symbol* Get(size_t id) const;
+
+    // Counts the parent's symbols too.
+    size_t Size() const;
+
+private:
+    const SymbolTable* parent_;
+    size_t first_id_;
+    // Keys view the name stored inside the Symbol itself.
+    std::unordered_map<std::string_view, size_t> ids_;
+    std::vector<std::unique_ptr<Symbol>> symbols_;
+};
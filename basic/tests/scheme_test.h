@@ -5,6 +5,14 @@
 #include <error.h>
 #include <scheme.h>
 
+inline InterpreterOptions TestInterpreterOptions() {
+    InterpreterOptions options;
+#ifdef SCHEME_TEST_BYTECODE
+    options.use_bytecode = true;
+#endif
+    return options;
+}
+
 class SchemeTest {
 public:
     void ExpectEq(std::string expression, const std::string& result) {
@@ -28,5 +36,5 @@ public:
     }
 
 private:
-    Interpreter interpreter_;
+    Interpreter interpreter_{TestInterpreterOptions()};
 };
@@ -0,0 +1,81 @@
+#include "scheme_test.h"
+
+#include <batch.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+std::vector<std::string> MakeSources(size_t count) {
+    std::vector<std::string> sources;
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 4) {
+            case 0:
+                sources.push_back("(+ " + std::to_string(i) + " 1)");
+                break;
+            case 1:
+                sources.push_back("'(" + std::to_string(i) + " . x)");
+                break;
+            case 2:
+                sources.push_back("(car '())");
+                break;
+            default:
+                sources.push_back("(+ 1");
+        }
+    }
+    return sources;
+}
+
+BatchOptions TestBatchOptions(size_t threads) {
+    return BatchOptions{.threads = threads, .interpreter = TestInterpreterOptions()};
+}
+
+}  // namespace
+
+TEST_CASE("Batch results come back in input order") {
+    auto sources = MakeSources(1000);
+    for (size_t threads : {1, 4, 0}) {
+        auto results = RunBatch(sources, TestBatchOptions(threads));
+        REQUIRE(results.size() == sources.size());
+
+        Interpreter serial{TestInterpreterOptions()};
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (i % 4 < 2) {
+                REQUIRE(!results[i].error);
+                REQUIRE(results[i].output == serial.Run(sources[i]));
+            } else if (i % 4 == 2) {
+                REQUIRE_THROWS_AS(std::rethrow_exception(results[i].error), RuntimeError);
+            } else {
+                REQUIRE_THROWS_AS(std::rethrow_exception(results[i].error), SyntaxError);
+            }
+        }
+    }
+    REQUIRE(RunBatch({}, TestBatchOptions(4)).empty());
+}
+
+TEST_CASE("Batch file runs one source per line") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_batch_test.scm";
+    std::ofstream(path) << "(+ 1 2)\n\n   \n'(1 2)\n(1 2)";
+    auto results = RunBatchFile(path.string(), TestBatchOptions(2));
+    std::filesystem::remove(path);
+
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0].output == "3");
+    REQUIRE(results[1].output == "(1 2)");
+    REQUIRE_THROWS_AS(std::rethrow_exception(results[2].error), RuntimeError);
+}
+
+TEST_CASE("Batch file may have CRLF line ends") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_batch_crlf_test.scm";
+    std::ofstream(path, std::ios::binary) << "(+ 1 2)\r\n\r\n  \r\n'(1 2)\r\n\t\r\n(+ 3 4)";
+    auto results = RunBatchFile(path.string(), TestBatchOptions(2));
+    std::filesystem::remove(path);
+
+    REQUIRE(results.size() == 4);
+    REQUIRE(results[0].output == "3");
+    REQUIRE(results[1].output == "(1 2)");
+    // A tab is no whitespace to the tokenizer, so its line is not blank.
+    REQUIRE_THROWS_AS(std::rethrow_exception(results[2].error), SyntaxError);
+    REQUIRE(results[3].output == "7");
+}
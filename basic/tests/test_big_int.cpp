@@ -0,0 +1,67 @@
+#include <catch.hpp>
+
+#include <random>
+#include <string>
+
+#include "big_int.h"
+
+namespace {
+
+std::string RandomDigits(std::mt19937_64* random, size_t count) {
+    std::string res(1, '1' + (*random)() % 9);
+    while (res.size() < count) {
+        res.push_back('0' + (*random)() % 10);
+    }
+    return res;
+}
+
+}  // namespace
+
+TEST_CASE("BigInt round-trips through decimal") {
+    for (std::string text : {"0", "1", "-1", "4294967295", "4294967296", "-18446744073709551616",
+                             "1000000000", "123456789012345678901234567890"}) {
+        REQUIRE(BigInt::FromString(text).ToString() == text);
+    }
+    REQUIRE(BigInt::FromString("+007").ToString() == "7");
+    REQUIRE(BigInt::FromString("-0").ToString() == "0");
+
+    REQUIRE(BigInt(INT64_MIN).ToString() == "-9223372036854775808");
+    REQUIRE(BigInt(INT64_MIN).FitsInt64());
+    REQUIRE(BigInt(INT64_MIN).ToInt64() == INT64_MIN);
+    REQUIRE(!(-BigInt(INT64_MIN)).FitsInt64());
+    REQUIRE((-BigInt(INT64_MIN) - BigInt(1)).ToInt64() == INT64_MAX);
+}
+
+TEST_CASE("BigInt arithmetic") {
+    auto power = BigInt(1);
+    for (int i = 0; i < 200; ++i) {
+        power = power * BigInt(2);
+    }
+    REQUIRE(power.ToString() == "1606938044258990275541962092341162602522202993782792835301376");
+    REQUIRE((power / BigInt(INT64_MIN)).ToString() ==
+            "-174224571863520493293247799005065324265472");
+    REQUIRE((BigInt(7) / BigInt(-2)).ToInt64() == -3);
+    REQUIRE((BigInt(-7) / BigInt(2)).ToInt64() == -3);
+    REQUIRE(Compare(BigInt(-3), BigInt(2)) < 0);
+    REQUIRE(Compare(-power, BigInt(INT64_MIN)) < 0);
+    REQUIRE(Compare(power, power * BigInt(1)) == 0);
+}
+
+TEST_CASE("Karatsuba products agree with division") {
+    // Sizes around and well past the schoolbook cutoff, balanced and not.
+    std::mt19937_64 random(7);
+    for (size_t lhs_digits : {5, 150, 300, 700, 2000}) {
+        for (size_t rhs_digits : {9, 290, 310, 1500}) {
+            auto lhs = BigInt::FromString(RandomDigits(&random, lhs_digits));
+            auto rhs = -BigInt::FromString(RandomDigits(&random, rhs_digits));
+            auto product = lhs * rhs;
+            REQUIRE(product == rhs * lhs);
+            REQUIRE(product / rhs == lhs);
+            REQUIRE(product / lhs == rhs);
+            // The product is negative and the quotient truncates toward zero.
+            REQUIRE((product - BigInt(1)) / lhs == rhs);
+            REQUIRE((product + BigInt(1)) / lhs == rhs + BigInt(1));
+            REQUIRE((lhs + rhs) * (lhs - rhs) == lhs * lhs - rhs * rhs);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include "scheme_test.h"
+#include <fuzzer.h>
+
+namespace {
+
+// Result of a request, or the kind of error it raised.
+std::string Outcome(Interpreter* interpreter, const std::string& request) {
+    try {
+        return interpreter->Run(request);
+    } catch (const SyntaxError&) {
+        return "SyntaxError";
+    } catch (const RuntimeError&) {
+        return "RuntimeError";
+    } catch (const NameError&) {
+        return "NameError";
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Bytecode matches the tree walker") {
+    Interpreter tree;
+    auto options = TestInterpreterOptions();
+    options.use_bytecode = true;
+    Interpreter bytecode{options};
+    for (auto expr : {"(+ 1 (* 2 3))", "(and 1 #f (foo))", "(or #f (foo))", "(or #f #f)",
+                      "(and)", "(or)", "(and ())", "(list (+ 1 2))", "(cons 1 '(2))", "(+ 1 . 2)",
+                      "(+ 1 . #t)", "(quote . 5)", "(1 2)", "(+ 1 (1 2))", "'.", "(+ (quote))",
+                      "(car (cdr '(1 2 3)))", "(list-tail '(1 2 3) (- 3 1))", "+",
+                      "(and . (quote (+ 1 2)))", "(and 1 . (quote (+ 1 2)))",
+                      "(and . '((+ 1 2)))", "(and . (1 . (quote (+ 1 2))))"}) {
+        REQUIRE(Outcome(&tree, expr) == Outcome(&bytecode, expr));
+    }
+}
+
+TEST_CASE("A quote in the dotted tail of a call is an operand") {
+    Interpreter interpreter{TestInterpreterOptions()};
+    REQUIRE(interpreter.Run("(and . (quote (+ 1 2)))") == "3");
+    REQUIRE(interpreter.Run("(and 1 . (quote (+ 1 2)))") == "3");
+    REQUIRE_THROWS_AS(interpreter.Run("(and . '((+ 1 2)))"), RuntimeError);
+    REQUIRE(interpreter.Run("(quote . ((+ 1 2)))") == "(+ 1 2)");
+    REQUIRE(interpreter.Run("'(1 . (quote 2))") == "(1 quote 2)");
+}
+
+TEST_CASE("Bytecode fuzzing against the tree walker") {
+    Fuzzer fuzzer;
+    Interpreter tree;
+    auto options = TestInterpreterOptions();
+    options.use_bytecode = true;
+    Interpreter bytecode{options};
+    for (int i = 0; i < 10000; ++i) {
+        auto request = fuzzer.Next();
+        INFO(request);
+        REQUIRE(Outcome(&tree, request) == Outcome(&bytecode, request));
+    }
+}
@@ -0,0 +1,69 @@
+#include "scheme_test.h"
+
+#include <global_environment.h>
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("Symbol tables extend their parent") {
+    SymbolTable parent;
+    auto a = parent.Intern("a");
+
+    SymbolTable child(&parent);
+    REQUIRE(child.Intern("a") == a);
+    REQUIRE(child.Intern("quote")->GetId() == SymbolTable::kQuote);
+
+    auto b = child.Intern("b");
+    REQUIRE(b->GetId() == parent.Size());
+    REQUIRE(child.Intern("b") == b);
+    REQUIRE(child.Get(b->GetId()) == b);
+    REQUIRE(child.Get(a->GetId()) == a);
+    REQUIRE(child.Size() == parent.Size() + 1);
+    REQUIRE(parent.Find("b") == nullptr);
+}
+
+TEST_CASE("Sessions share one environment") {
+    auto environment = std::make_shared<const GlobalEnvironment>();
+    Interpreter first(environment, TestInterpreterOptions());
+    Interpreter second(environment, TestInterpreterOptions());
+
+    REQUIRE(first.Run("(+ 1 2)") == "3");
+    REQUIRE(first.Run("'(foo bar)") == "(foo bar)");
+    REQUIRE_THROWS_AS(first.Run("(foo 1)"), RuntimeError);
+
+    // Names one session read stay out of the environment and the others.
+    REQUIRE(environment->GetSymbols().Find("foo") == nullptr);
+    REQUIRE(second.Run("'(bar foo)") == "(bar foo)");
+    REQUIRE_THROWS_AS(second.Run("(bar 1)"), RuntimeError);
+}
+
+TEST_CASE("Sessions run concurrently") {
+    auto environment = std::make_shared<const GlobalEnvironment>();
+    std::vector<std::string> requests;
+    for (int i = 0; i < 500; ++i) {
+        auto n = std::to_string(i);
+        requests.push_back("(+ " + n + " (max 1 " + n + ") (abs -" + n + "))");
+        requests.push_back("'(name" + n + " " + n + " . tail" + n + ")");
+    }
+
+    Interpreter serial(environment, TestInterpreterOptions());
+    std::vector<std::string> expected;
+    for (const auto& request : requests) {
+        expected.push_back(serial.Run(request));
+    }
+
+    std::vector<std::vector<std::string>> outputs(8);
+    std::vector<std::jthread> threads;
+    for (auto& output : outputs) {
+        threads.emplace_back([&] {
+            Interpreter session(environment, TestInterpreterOptions());
+            for (const auto& request : requests) {
+                output.push_back(session.Run(request));
+            }
+        });
+    }
+    threads.clear();
+    for (const auto& output : outputs) {
+        REQUIRE(output == expected);
+    }
+}
@@ -1,5 +1,7 @@
 #include "scheme_test.h"
 
+#include <sstream>
+
 TEST_CASE_METHOD(SchemeTest, "Quote") {
     ExpectEq("(quote (1 2))", "(1 2)");
     ExpectEq("'(1 2)", "(1 2)");
@@ -12,3 +14,64 @@ TEST_CASE_METHOD(SchemeTest, "Be careful") {
     ExpectRuntimeError("('() ())");
     ExpectEq("'(())", "(())");
 }
+
+TEST_CASE("Heap and arena parsing agree") {
+    auto options = TestInterpreterOptions();
+    options.use_arena = false;
+    Interpreter heap{options};
+    options.use_arena = true;
+    Interpreter arena{options};
+    for (auto expr : {"'(1 (2 . 3) #t)", "(+ 1 (* 2 3))", "(cdr '(1 2 3))", "(list 1 2)"}) {
+        REQUIRE(heap.Run(expr) == arena.Run(expr));
+    }
+}
+
+TEST_CASE_METHOD(SchemeTest, "Deep and long input") {
+    auto nested_sum = [](size_t depth) {
+        std::string sum;
+        for (size_t i = 0; i < depth; ++i) {
+            sum += "(+ 1 ";
+        }
+        return sum + "0" + std::string(depth, ')');
+    };
+    ExpectEq(nested_sum(1000), "1000");
+    ExpectSyntaxError(nested_sum(1001));
+    ExpectSyntaxError(std::string(100000, '\'') + "1");
+    ExpectEq("'" + std::string(999, '(') + "1" + std::string(999, ')'), "(1)");
+
+    std::string items;
+    for (int i = 0; i < 100000; ++i) {
+        items += "1 ";
+    }
+    std::string expected = "(" + items;
+    expected.back() = ')';
+    ExpectEq("'(" + items + ")", expected);
+}
+
+TEST_CASE("Run into a stream") {
+    Interpreter interpreter{TestInterpreterOptions()};
+    std::string items;
+    for (int i = 0; i < 50000; ++i) {
+        items += "(" + std::to_string(i) + " . #t) ";
+    }
+    for (const auto& expr : std::vector<std::string>{"'(1 (2 3) () . 4)", "(+ 1 2)", "+",
+                                                     "'(" + items + ")"}) {
+        std::stringstream out;
+        interpreter.Run(expr, &out);
+        REQUIRE(out.str() == interpreter.Run(expr));
+    }
+    std::stringstream out;
+    REQUIRE_THROWS_AS(interpreter.Run("(car '())", &out), RuntimeError);
+    REQUIRE(out.str().empty());
+}
+
+TEST_CASE_METHOD(SchemeTest, "Calls with many arguments") {
+    std::string ones;
+    for (int i = 0; i < 5000; ++i) {
+        ones += " 1";
+    }
+    std::string sum = "(+" + ones + ")";
+    ExpectEq(sum, "5000");
+    ExpectEq("(and " + sum + " (max" + ones + " " + sum + ") " + sum + ")", "5000");
+    ExpectEq("(or #f (+ 1 (* 2" + ones + ")))", "3");
+}
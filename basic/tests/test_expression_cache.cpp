@@ -0,0 +1,70 @@
+#include "scheme_test.h"
+
+TEST_CASE("Repeated requests hit the cache") {
+    Interpreter interpreter{TestInterpreterOptions()};
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    REQUIRE(interpreter.Run("'(1 2)") == "(1 2)");
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+
+    const auto& stats = interpreter.GetCacheStats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.size == 2);
+
+    REQUIRE_THROWS_AS(interpreter.Run("(foo)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(foo)"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(+ 1"), SyntaxError);
+    REQUIRE(stats.size == 3);
+
+    interpreter.ClearCache();
+    REQUIRE(stats.size == 0);
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    REQUIRE(stats.misses == 5);
+}
+
+TEST_CASE("Least recently used requests are evicted") {
+    auto options = TestInterpreterOptions();
+    options.cache_capacity = 2;
+    options.heap = {.min_collect_bytes = 1, .growth_factor = 0};
+    Interpreter interpreter{options};
+    interpreter.Run("1");
+    interpreter.Run("'(1 2)");
+    interpreter.Run("1");
+    interpreter.Run("'(3 4)");
+
+    const auto& stats = interpreter.GetCacheStats();
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(stats.size == 2);
+    REQUIRE(interpreter.Run("1") == "1");
+    REQUIRE(stats.hits == 2);
+    REQUIRE(interpreter.Run("'(1 2)") == "(1 2)");
+    REQUIRE(stats.hits == 2);
+
+    interpreter.SetCacheCapacity(0);
+    REQUIRE(stats.size == 0);
+    REQUIRE(interpreter.Run("(cons 1 2)") == "(1 . 2)");
+    REQUIRE(interpreter.GetHeapStats().objects_live == 0);
+}
+
+TEST_CASE("Long requests are not cached") {
+    auto options = TestInterpreterOptions();
+    options.cache_max_request_size = 16;
+    Interpreter interpreter{options};
+    std::string request = "'(";
+    for (int i = 0; i < 100; ++i) {
+        request += std::to_string(i) + " ";
+    }
+    request += ")";
+    interpreter.Run(request);
+    interpreter.Run(request);
+
+    const auto& stats = interpreter.GetCacheStats();
+    REQUIRE(stats.size == 0);
+    REQUIRE(stats.hits == 0);
+    // Read into the arena rather than onto the heap.
+    REQUIRE(interpreter.GetHeapStats().objects_made[static_cast<size_t>(ObjectType::kList)] == 0);
+
+    interpreter.Run("(+ 1 2)");
+    REQUIRE(stats.size == 1);
+}
@@ -9,7 +9,7 @@ static constexpr uint32_t kShotsCount = 100000;
 
 TEST_CASE("Fuzzing-2") {
     Fuzzer fuzzer;
-    Interpreter interpreter;
+    Interpreter interpreter{TestInterpreterOptions()};
 
     for (uint32_t i = 0; i < kShotsCount; ++i) {
         try {
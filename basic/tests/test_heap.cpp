@@ -0,0 +1,71 @@
+#include "scheme_test.h"
+
+#include <heap.h>
+
+namespace {
+
+Cell* MakePair(Heap* heap, Object* first, Object* second) {
+    auto cell = heap->Make<Cell>();
+    cell->GetFirst() = first;
+    cell->GetSecond() = second;
+    return cell;
+}
+
+}  // namespace
+
+TEST_CASE("Heap frees unreachable objects") {
+    Heap heap;
+    Object* root = MakePair(&heap, MakePair(&heap, nullptr, nullptr), MakeNumber(&heap, 1 << 20));
+    MakePair(&heap, root, nullptr);
+    heap.AddRoot(&root);
+    REQUIRE(heap.GetStats().objects_live == 4);
+
+    heap.Collect();
+    REQUIRE(heap.GetStats().objects_live == 3);
+    REQUIRE(As<Number>(As<Cell>(root)->GetSecond())->GetValue() == 1 << 20);
+
+    heap.RemoveRoot(&root);
+    heap.Collect();
+    REQUIRE(heap.GetStats().objects_live == 0);
+    REQUIRE(heap.GetStats().bytes_live == 0);
+    REQUIRE(heap.GetStats().collections == 2);
+}
+
+TEST_CASE("Heap frees cycles") {
+    Heap heap;
+    auto first = MakePair(&heap, MakeNumber(&heap, 1), nullptr);
+    auto second = MakePair(&heap, MakeNumber(&heap, 2), first);
+    first->GetSecond() = second;
+
+    Object* root = first;
+    heap.AddRoot(&root);
+    heap.Collect();
+    REQUIRE(heap.GetStats().objects_live == 2);
+
+    root = nullptr;
+    heap.Collect();
+    REQUIRE(heap.GetStats().objects_live == 0);
+}
+
+TEST_CASE("Heap collects only past the threshold") {
+    Heap heap{HeapOptions{.min_collect_bytes = 100 * sizeof(Cell)}};
+    for (int i = 0; i < 99; ++i) {
+        heap.Make<Cell>();
+    }
+    heap.MaybeCollect();
+    REQUIRE(heap.GetStats().collections == 0);
+
+    heap.Make<Cell>();
+    heap.MaybeCollect();
+    REQUIRE(heap.GetStats().collections == 1);
+    REQUIRE(heap.GetStats().objects_live == 0);
+}
+
+TEST_CASE("Interpreter reclaims garbage between requests") {
+    Interpreter interpreter{
+        InterpreterOptions{.cache_capacity = 0, .heap = {.min_collect_bytes = 1}}};
+    REQUIRE(interpreter.Run("(cdr '(1 2 3))") == "(2 3)");
+    REQUIRE(interpreter.Run("(cons 1 2)") == "(1 . 2)");
+    REQUIRE(interpreter.GetHeapStats().collections == 2);
+    REQUIRE(interpreter.GetHeapStats().objects_live == 0);
+}
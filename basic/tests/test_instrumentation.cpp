@@ -0,0 +1,118 @@
+#include "scheme_test.h"
+
+#include <instrumentation.h>
+
+#include <numeric>
+
+namespace {
+
+InterpreterOptions InstrumentedOptions() {
+    auto options = TestInterpreterOptions();
+    options.instrument = true;
+    return options;
+}
+
+size_t CountCalls(const InterpreterStats& stats, const std::string& name) {
+    for (const auto& builtin : stats.builtins) {
+        if (builtin.name == name) {
+            return builtin.calls;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+TEST_CASE("Instrumentation is off by default") {
+    Interpreter interpreter{TestInterpreterOptions()};
+    interpreter.Run("(+ 1 2)");
+    auto stats = interpreter.GetStats();
+    REQUIRE(stats.requests == 0);
+    REQUIRE(stats.builtins.empty());
+    REQUIRE(stats.read_time.count() == 0);
+}
+
+TEST_CASE("Instrumentation counts builtin calls and requests") {
+    Interpreter interpreter{InstrumentedOptions()};
+    for (int i = 0; i < 3; ++i) {
+        interpreter.Run("(+ 1 2)");
+    }
+    interpreter.Run("(max 1 (abs -2) (abs 3))");
+    REQUIRE_THROWS_AS(interpreter.Run("(car '())"), RuntimeError);
+
+    auto stats = interpreter.GetStats();
+    REQUIRE(CountCalls(stats, "+") == 3);
+    REQUIRE(CountCalls(stats, "max") == 1);
+    REQUIRE(CountCalls(stats, "abs") == 2);
+    REQUIRE(CountCalls(stats, "car") == 1);
+    REQUIRE(CountCalls(stats, "min") == 0);
+
+    // The failed request made calls, but did not complete.
+    REQUIRE(stats.requests == 4);
+    REQUIRE(std::accumulate(stats.request_latency.begin(), stats.request_latency.end(),
+                            size_t{0}) == 4);
+}
+
+TEST_CASE("Instrumentation counts objects by type") {
+    Interpreter interpreter{InstrumentedOptions()};
+    interpreter.Run("'(first second third)");
+    interpreter.Run("(+ 100000 100000)");
+
+    auto stats = interpreter.GetStats();
+    REQUIRE(stats.objects_made[static_cast<size_t>(ObjectType::kSymbol)] == 3);
+    REQUIRE(stats.objects_made[static_cast<size_t>(ObjectType::kNumber)] >= 1);
+    REQUIRE(stats.objects_made[static_cast<size_t>(ObjectType::kBool)] == 0);
+}
+
+TEST_CASE("Instrumentation counts objects read into the arena") {
+    auto options = InstrumentedOptions();
+    options.cache_capacity = 0;
+    Interpreter interpreter{options};
+    interpreter.Run("(+ 1 (+ 2 3))");
+
+    auto stats = interpreter.GetStats();
+    REQUIRE(stats.objects_made[static_cast<size_t>(ObjectType::kCell)] >= 6);
+    REQUIRE(interpreter.GetHeapStats().objects_made[static_cast<size_t>(ObjectType::kCell)] == 0);
+}
+
+TEST_CASE("Instrumentation counts calls on every thread") {
+    auto options = InstrumentedOptions();
+    options.parallel_threads = 4;
+    Interpreter interpreter{options};
+    std::string list = "'(";
+    for (int i = 0; i < 5000; ++i) {
+        list += std::to_string(-i) + " ";
+    }
+    interpreter.Run("(parallel-map abs " + list + "))");
+    REQUIRE(CountCalls(interpreter.GetStats(), "abs") == 5000);
+}
+
+TEST_CASE("Latency buckets") {
+    using std::chrono::microseconds;
+    REQUIRE(GetLatencyBucket(std::chrono::nanoseconds(10)) == 0);
+    REQUIRE(GetLatencyBucket(microseconds(1)) == 0);
+    REQUIRE(GetLatencyBucket(microseconds(2)) == 1);
+    REQUIRE(GetLatencyBucket(microseconds(3)) == 2);
+    REQUIRE(GetLatencyBucket(microseconds(1 << 20)) == 20);
+    REQUIRE(GetLatencyBucket(std::chrono::hours(1)) == kLatencyBuckets - 1);
+    for (size_t i = 0; i + 1 < kLatencyBuckets; ++i) {
+        REQUIRE(GetLatencyBucket(GetLatencyBucketBound(i)) == i);
+    }
+}
+
+TEST_CASE("Instrumentation stats format") {
+    Interpreter interpreter{InstrumentedOptions()};
+    interpreter.Run("(+ 1 2)");
+    interpreter.Run("(+ 1 2)");
+    auto stats = interpreter.GetStats();
+
+    auto json = FormatJson(stats);
+    REQUIRE(json.starts_with("{\"requests\":2,"));
+    REQUIRE(json.find("{\"name\":\"+\",\"calls\":2,") != std::string::npos);
+    REQUIRE(json.ends_with("}"));
+
+    auto text = FormatPrometheus(stats);
+    REQUIRE(text.find("scheme_builtin_calls_total{builtin=\"+\"} 2\n") != std::string::npos);
+    REQUIRE(text.find("scheme_request_seconds_bucket{le=\"+Inf\"} 2\n") != std::string::npos);
+    REQUIRE(text.find("scheme_request_seconds_count 2\n") != std::string::npos);
+}
@@ -10,6 +10,7 @@ TEST_CASE_METHOD(SchemeTest, "IntegerPredicate") {
     ExpectEq("(number? -1)", "#t");
     ExpectEq("(number? 1)", "#t");
     ExpectEq("(number? #t)", "#f");
+    ExpectRuntimeError("(number?)");
 }
 
 TEST_CASE_METHOD(SchemeTest, "IntegerComparison") {
@@ -81,6 +82,7 @@ TEST_CASE_METHOD(SchemeTest, "IntegerArithmeticsEdgeCases") {
     ExpectEq("(*)", "1");
     ExpectRuntimeError("(/)");
     ExpectRuntimeError("(-)");
+    ExpectRuntimeError("(/ 1 0)");
 }
 
 TEST_CASE_METHOD(SchemeTest, "IntegerMaxMin") {
@@ -102,6 +104,61 @@ TEST_CASE_METHOD(SchemeTest, "IntegerMaxMinEdgeCases") {
     ExpectRuntimeError("(min #t)");
 }
 
+TEST_CASE_METHOD(SchemeTest, "IntegerLongArgumentLists") {
+    // Long enough to be unboxed in several blocks.
+    std::string values;
+    for (int i = 1; i <= 600; ++i) {
+        values += " " + std::to_string(i);
+    }
+    ExpectEq("(+" + values + ")", "180300");
+    ExpectEq("(-" + values + ")", "-180298");
+    ExpectEq("(max" + values + ")", "600");
+    ExpectEq("(min" + values + ")", "1");
+    ExpectEq("(<" + values + ")", "#t");
+    ExpectEq("(<=" + values + " 600)", "#t");
+    ExpectEq("(<" + values + " 600)", "#f");
+    ExpectEq("(>" + values + ")", "#f");
+    ExpectEq("(=" + values + ")", "#f");
+
+    // A broken pair right across the first block boundary.
+    std::string ramp;
+    for (int i = 0; i < 600; ++i) {
+        ramp += " " + std::to_string(i == 256 ? 0 : i);
+    }
+    ExpectEq("(<" + ramp + ")", "#f");
+    ExpectEq("(>= 5 5 5 5 5 5 5 5 5 4 4 4 4 4 -7)", "#t");
+    ExpectEq("(= 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 8)", "#f");
+    ExpectRuntimeError("(+" + values + " #t)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "IntegerOverflowPromotes") {
+    ExpectEq("2147483648", "2147483648");
+    ExpectEq("(+ 2147483647 1)", "2147483648");
+    ExpectEq("(+ 9223372036854775807 1)", "9223372036854775808");
+    ExpectEq("(- -9223372036854775808 1)", "-9223372036854775809");
+    ExpectEq("(- 0 -9223372036854775808)", "9223372036854775808");
+    ExpectEq("(* 4294967296 4294967296)", "18446744073709551616");
+    ExpectEq("(* 99999999999 99999999999 -99999999999)",
+             "-999999999970000000000299999999999");
+    ExpectEq("(/ -9223372036854775808 -1)", "9223372036854775808");
+    ExpectEq("(abs -9223372036854775808)", "9223372036854775808");
+
+    // Results that fit again are plain numbers.
+    ExpectEq("(- 9223372036854775808 1)", "9223372036854775807");
+    ExpectEq("(+ 9223372036854775807 1 -1)", "9223372036854775807");
+    ExpectEq("(/ 18446744073709551616 4294967296)", "4294967296");
+    ExpectEq("(= (- 9223372036854775808 1) 9223372036854775807)", "#t");
+
+    ExpectEq("(< 1 9223372036854775808 99999999999999999999)", "#t");
+    ExpectEq("(> -99999999999999999999 -9223372036854775809 0)", "#f");
+    ExpectEq("(= 99999999999999999999 99999999999999999999)", "#t");
+    ExpectEq("(max 1 99999999999999999999 -99999999999999999999)", "99999999999999999999");
+    ExpectEq("(min 1 99999999999999999999 -99999999999999999999)", "-99999999999999999999");
+    ExpectEq("(- 99999999999999999999)", "99999999999999999999");
+    ExpectRuntimeError("(/ 99999999999999999999 0)");
+    ExpectRuntimeError("(+ 99999999999999999999 #t)");
+}
+
 TEST_CASE_METHOD(SchemeTest, "IntegerAbs") {
     ExpectEq("(abs 10)", "10");
     ExpectEq("(abs -10)", "10");
@@ -112,3 +169,16 @@ TEST_CASE_METHOD(SchemeTest, "IntegerAbsEdgeCases") {
     ExpectRuntimeError("(abs #t)");
     ExpectRuntimeError("(abs 1 2)");
 }
+
+TEST_CASE("Small numbers and booleans are preallocated") {
+    Heap heap;
+    REQUIRE(MakeNumber(&heap, 5) == MakeNumber(&heap, 5));
+    REQUIRE(MakeBool(true) == MakeBool(true));
+    REQUIRE(MakeBool(false)->GetBool() == false);
+    REQUIRE(heap.GetStats().objects_live == 0);
+
+    auto big = MakeNumber(&heap, 1 << 20);
+    REQUIRE(big->GetValue() == 1 << 20);
+    REQUIRE(MakeNumber(&heap, -100000)->GetValue() == -100000);
+    REQUIRE(heap.GetStats().objects_live == 2);
+}
@@ -78,3 +78,27 @@ TEST_CASE_METHOD(SchemeTest, "ListOperations") {
     ExpectRuntimeError("(list-ref '(1 2 3) 10)");
     ExpectRuntimeError("(list-tail '(1 2 3) 10)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "Length") {
+    ExpectEq("(length '())", "0");
+    ExpectEq("(length '(1 (2 3) 4))", "3");
+    ExpectEq("(length '(1 . (2 3)))", "3");
+    ExpectEq("(length (cdr '(1 2 3)))", "2");
+
+    ExpectRuntimeError("(length '(1 . 2))");
+    ExpectRuntimeError("(length 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Large quoted table") {
+    std::string table = "'(";
+    for (int i = 0; i < 100000; ++i) {
+        table += "(" + std::to_string(i) + " x) ";
+    }
+    table += ")";
+
+    ExpectEq("(length " + table + ")", "100000");
+    ExpectEq("(list-ref " + table + " 99999)", "(99999 x)");
+    ExpectEq("(car (list-tail " + table + " 99998))", "99998");
+    ExpectEq("(list-ref '(1 2 . 3) 2)", "3");
+    ExpectEq("(list-tail '(1 2 . 3) 2)", "3");
+}
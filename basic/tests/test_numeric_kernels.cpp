@@ -0,0 +1,89 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "numeric_kernels.h"
+
+TEST_CASE("Vector kernels agree with the scalar ones") {
+    const auto& scalar = GetNumericKernels(SimdLevel::kScalar);
+    std::vector<SimdLevel> levels = {SimdLevel::kScalar};
+    if (DetectSimdLevel() >= SimdLevel::kSse42) {
+        levels.push_back(SimdLevel::kSse42);
+    }
+    if (DetectSimdLevel() >= SimdLevel::kAvx2) {
+        levels.push_back(SimdLevel::kAvx2);
+    }
+
+    std::mt19937_64 random(42);
+    for (size_t count = 1; count <= 40; ++count) {
+        for (int round = 0; round < 50; ++round) {
+            std::vector<int64_t> values(count);
+            // Mostly small values so that pairs are often equal, sometimes
+            // the extremes.
+            for (auto& value : values) {
+                switch (random() % 8) {
+                    case 0:
+                        value = std::numeric_limits<int64_t>::min();
+                        break;
+                    case 1:
+                        value = std::numeric_limits<int64_t>::max();
+                        break;
+                    default:
+                        value = static_cast<int64_t>(random() % 5) - 2;
+                }
+            }
+            if (round % 2 == 0) {
+                std::sort(values.begin(), values.end());
+            }
+            const auto* data = values.data();
+            __int128 exact_sum = 0;
+            bool small_values = true;
+            for (auto value : values) {
+                exact_sum += value;
+                small_values = small_values && value >= -2 && value <= 2;
+            }
+            for (auto level : levels) {
+                const auto& kernels = GetNumericKernels(level);
+                // A sum that is returned is exact, and one of small values
+                // cannot overflow.
+                int64_t sum;
+                if (kernels.sum(data, count, &sum)) {
+                    REQUIRE(sum == exact_sum);
+                } else {
+                    REQUIRE(!small_values);
+                }
+                REQUIRE(kernels.max(data, count) == scalar.max(data, count));
+                REQUIRE(kernels.min(data, count) == scalar.min(data, count));
+                REQUIRE(kernels.equal(data, count) == scalar.equal(data, count));
+                REQUIRE(kernels.less(data, count) == scalar.less(data, count));
+                REQUIRE(kernels.greater(data, count) == scalar.greater(data, count));
+                REQUIRE(kernels.less_equal(data, count) == scalar.less_equal(data, count));
+                REQUIRE(kernels.greater_equal(data, count) ==
+                        scalar.greater_equal(data, count));
+            }
+        }
+    }
+}
+
+TEST_CASE("Pairwise kernels check every adjacent pair") {
+    for (auto level : {SimdLevel::kScalar, DetectSimdLevel()}) {
+        const auto& kernels = GetNumericKernels(level);
+        std::vector<int64_t> ramp(37);
+        for (size_t i = 0; i < ramp.size(); ++i) {
+            ramp[i] = i;
+        }
+        REQUIRE(kernels.less(ramp.data(), ramp.size()));
+        REQUIRE(kernels.less(ramp.data(), 1));
+        REQUIRE(kernels.greater(ramp.data(), 0));
+        for (size_t broken = 1; broken < ramp.size(); ++broken) {
+            auto copy = ramp;
+            copy[broken] = copy[broken - 1];
+            REQUIRE_FALSE(kernels.less(copy.data(), copy.size()));
+            REQUIRE(kernels.less_equal(copy.data(), copy.size()));
+        }
+    }
+}
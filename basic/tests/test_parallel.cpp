@@ -0,0 +1,138 @@
+#include "scheme_test.h"
+
+#include <work_stealing_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+InterpreterOptions ParallelOptions(size_t min_args = 0) {
+    auto options = TestInterpreterOptions();
+    options.parallel_threads = 4;
+    options.parallel_min_args = min_args;
+    return options;
+}
+
+std::string QuotedRange(int from, int to) {
+    std::string list = "'(";
+    for (int i = from; i < to; ++i) {
+        list += std::to_string(i) + " ";
+    }
+    return list + ")";
+}
+
+// Message of the error evaluating expression raises, or "" if it raises none.
+std::string ErrorOf(Interpreter* interpreter, const std::string& expression) {
+    try {
+        interpreter->Run(expression);
+    } catch (const RuntimeError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+}  // namespace
+
+TEST_CASE("Parallel loops run every index once") {
+    WorkStealingPool pool(3);
+    std::vector<std::atomic<int>> hits(100000);
+    pool.ParallelFor(hits.size(), 7, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ++hits[i];
+        }
+    });
+    for (auto& hit : hits) {
+        REQUIRE(hit == 1);
+    }
+
+    std::atomic<size_t> nested = 0;
+    pool.ParallelFor(64, 1, [&](size_t, size_t) {
+        pool.ParallelFor(64, 1, [&](size_t, size_t) { ++nested; });
+    });
+    REQUIRE(nested == 64 * 64);
+}
+
+TEST_CASE("Parallel loops rethrow the first error") {
+    WorkStealingPool pool(3);
+    for (int run = 0; run < 20; ++run) {
+        REQUIRE_THROWS_WITH(pool.ParallelFor(10000, 10,
+                                             [](size_t begin, size_t) {
+                                                 if (begin == 2370 || begin >= 5000) {
+                                                     throw std::runtime_error(
+                                                         std::to_string(begin));
+                                                 }
+                                             }),
+                            "2370");
+    }
+}
+
+TEST_CASE_METHOD(SchemeTest, "Map") {
+    ExpectEq("(map abs '(1 -2 3))", "(1 2 3)");
+    ExpectEq("(parallel-map abs '(1 -2 3))", "(1 2 3)");
+    ExpectEq("(map number? '(1 #t))", "(#t #f)");
+    ExpectEq("(map abs '())", "()");
+
+    ExpectRuntimeError("(map abs '(1 #t))");
+    ExpectRuntimeError("(parallel-map abs '(1 #t))");
+    ExpectRuntimeError("(map abs '(1 . 2))");
+    ExpectRuntimeError("(map 1 '(1))");
+    ExpectRuntimeError("(map quote '(1 2))");
+    ExpectRuntimeError("(map and '((1 2)))");
+    ExpectRuntimeError("(parallel-map or '(#t))");
+    ExpectRuntimeError("(map abs)");
+}
+
+TEST_CASE("Parallel map over long lists") {
+    Interpreter serial{TestInterpreterOptions()};
+    Interpreter parallel{ParallelOptions()};
+
+    auto list = QuotedRange(-20000, 20000);
+    auto expected = serial.Run("(map abs " + list + ")");
+    for (int run = 0; run < 5; ++run) {
+        REQUIRE(parallel.Run("(parallel-map abs " + list + ")") == expected);
+    }
+    REQUIRE(parallel.Run("(parallel-map - " + list + ")") == serial.Run("(map - " + list + ")"));
+
+    // Only the leftmost bad element counts, wherever the others are.
+    std::string bad = "'(";
+    for (int i = 0; i < 20000; ++i) {
+        bad += i == 10000 ? "#t " : std::to_string(i) + " ";
+    }
+    bad += "#f)";
+    for (int run = 0; run < 5; ++run) {
+        REQUIRE_THROWS_AS(parallel.Run("(parallel-map abs " + bad + ")"), RuntimeError);
+    }
+}
+
+TEST_CASE("Arguments evaluate in parallel like in order") {
+    Interpreter serial{TestInterpreterOptions()};
+    Interpreter parallel{ParallelOptions(2)};
+
+    std::string sum = "(+";
+    for (int i = 0; i < 2000; ++i) {
+        sum += " (* " + std::to_string(i) + " (max 1 " + std::to_string(i) + " 2))";
+    }
+    sum += ")";
+    REQUIRE(parallel.Run(sum) == serial.Run(sum));
+    REQUIRE(parallel.Run("(list? (list 1 2 3))") == serial.Run("(list? (list 1 2 3))"));
+
+    // The first failing argument decides the error, as it does in order.
+    std::string failing = "(+";
+    for (int i = 0; i < 2000; ++i) {
+        if (i == 700) {
+            failing += " (car '())";
+        } else if (i > 1000 && i % 3 == 0) {
+            failing += " (/ 1 0)";
+        } else {
+            failing += " " + std::to_string(i);
+        }
+    }
+    failing += ")";
+    auto expected = ErrorOf(&serial, failing);
+    REQUIRE(!expected.empty());
+    for (int run = 0; run < 10; ++run) {
+        REQUIRE(ErrorOf(&parallel, failing) == expected);
+    }
+}
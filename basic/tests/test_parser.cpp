@@ -1,6 +1,8 @@
 #include <catch.hpp>
 
+#include <functional>
 #include <sstream>
+#include <vector>
 
 #include <error.h>
 #include <parser.h>
@@ -51,6 +53,27 @@ TEST_CASE("Read symbol") {
     }
 }
 
+TEST_CASE("Symbols are interned") {
+    std::stringstream ss{"(+ foo + 'foo)"};
+    Tokenizer tokenizer{&ss};
+    SymbolTable symbols;
+    Heap heap;
+    auto list = Read(&tokenizer, &symbols, &heap);
+
+    auto plus = As<Cell>(list)->GetFirst();
+    list = As<Cell>(list)->GetSecond();
+    auto foo = As<Cell>(list)->GetFirst();
+    list = As<Cell>(list)->GetSecond();
+    REQUIRE(As<Cell>(list)->GetFirst() == plus);
+
+    auto quoted = As<Cell>(As<Cell>(list)->GetSecond())->GetFirst();
+    REQUIRE(As<Cell>(quoted)->GetFirst() == symbols.Get(SymbolTable::kQuote));
+    REQUIRE(As<Cell>(As<Cell>(quoted)->GetSecond())->GetFirst() == foo);
+
+    REQUIRE(As<Symbol>(plus)->GetId() != As<Symbol>(foo)->GetId());
+    REQUIRE(symbols.Intern("foo") == foo);
+}
+
 TEST_CASE("Lists") {
     SECTION("Empty list") {
         auto null = ReadFull("()");
@@ -154,3 +177,138 @@ TEST_CASE("Invalid") {
     REQUIRE_THROWS_AS(ReadFull("(1 . )"), SyntaxError);
     REQUIRE_THROWS_AS(ReadFull("(1 . 2 3)"), SyntaxError);
 }
+
+TEST_CASE("Syntax errors carry positions") {
+    REQUIRE_THROWS_WITH(ReadFull("(1 2"), "Wrong Syntax at 1:5");
+    REQUIRE_THROWS_WITH(ReadFull("(1 2)\n 3"), "Wrong Syntax at 2:2");
+    REQUIRE_THROWS_WITH(ReadFull("(1\n . 2 3)"), "Wrong Syntax at 2:7");
+    REQUIRE_THROWS_WITH(ReadFull(")"), "Wrong Syntax at 1:1");
+}
+
+TEST_CASE("Lists keep their source offsets") {
+    std::string source = "(f 1\n  (g '(2 3)) '4)";
+    Tokenizer tokenizer{std::string_view(source)};
+    SymbolTable symbols;
+    Heap heap;
+    auto outer = Read(&tokenizer, &symbols, &heap);
+    REQUIRE(outer->GetSourceOffset() == 0);
+
+    auto inner = As<Cell>(As<Cell>(As<Cell>(outer)->GetSecond())->GetSecond())->GetFirst();
+    REQUIRE(inner->GetSourceOffset() == 7);
+    REQUIRE(LocateOffset(source, inner->GetSourceOffset()) == SourcePosition{7, 2, 3});
+
+    auto quote = As<Cell>(As<Cell>(inner)->GetSecond())->GetFirst();
+    REQUIRE(quote->GetSourceOffset() == 10);
+    auto data = As<Cell>(As<Cell>(quote)->GetSecond())->GetFirst();
+    REQUIRE(Is<List>(data));
+    REQUIRE(data->GetSourceOffset() == 11);
+
+    // Made at runtime, or shared between places.
+    REQUIRE(heap.Make<Cell>()->GetSourceOffset() == Object::kNoSourceOffset);
+    REQUIRE(As<Cell>(outer)->GetFirst()->GetSourceOffset() == Object::kNoSourceOffset);
+}
+
+std::string DescribeRead(const std::function<Object*()>& read) {
+    try {
+        auto obj = read();
+        return obj ? obj->Serialize() : "()";
+    } catch (const SyntaxError& error) {
+        return error.what();
+    }
+}
+
+TEST_CASE("Push reader agrees with Read") {
+    std::vector<std::string> inputs = {
+        "5",           "-5",           "+",          "foo-bar?",  "#t",
+        "(1 2 . 3)",   "'(a (b . c) '4)",            "(+ 12345 -678)",
+        "99999999999999999999999",     "(1 2",       "(1\n . 2 3)",
+        ")",           "(1 @ 2)",      "(. 1)",      "'",         "  (f\n\n  '(x . -))  ",
+    };
+    SymbolTable symbols;
+    Heap heap;
+    for (const auto& input : inputs) {
+        auto expected = DescribeRead([&input] {
+            Tokenizer tokenizer{std::string_view(input)};
+            return Read(&tokenizer);
+        });
+        for (size_t chunk_size : {size_t{1}, size_t{2}, size_t{3}, input.size()}) {
+            auto pushed = DescribeRead([&] {
+                PushReader reader(&symbols, &heap);
+                std::vector<Object*> datums;
+                for (size_t i = 0; i < input.size(); i += chunk_size) {
+                    reader.Feed(std::string_view(input).substr(i, chunk_size), &datums);
+                }
+                reader.Finish(&datums);
+                REQUIRE(datums.size() == 1);
+                return datums.front();
+            });
+            INFO(input << " in chunks of " << chunk_size);
+            REQUIRE(pushed == expected);
+        }
+    }
+}
+
+TEST_CASE("Push reader hands out datums as they close") {
+    SymbolTable symbols;
+    Heap heap;
+    PushReader reader(&symbols, &heap);
+    std::vector<Object*> datums;
+    auto describe = [&datums] {
+        std::string out;
+        for (auto datum : datums) {
+            out += datum ? datum->Serialize() : "()";
+            out += ";";
+        }
+        datums.clear();
+        return out;
+    };
+
+    reader.Feed("(1 2) 3", &datums);
+    REQUIRE(describe() == "(1 2);");
+    reader.Feed("4 '(5", &datums);
+    REQUIRE(describe() == "34;");
+    REQUIRE(reader.HasOpenDatum());
+    reader.Feed(" 6) () foo", &datums);
+    REQUIRE(describe() == "(quote 5 6);();");
+    REQUIRE(!reader.HasOpenDatum());
+    reader.Finish(&datums);
+    REQUIRE(describe() == "foo;");
+
+    PushReader unfinished(&symbols, &heap);
+    unfinished.Feed("(1\n (2", &datums);
+    REQUIRE_THROWS_WITH(unfinished.Finish(&datums), "Wrong Syntax at 2:4");
+}
+
+TEST_CASE("Read into an arena") {
+    std::pmr::monotonic_buffer_resource arena;
+    std::stringstream ss{"(1 (foo . 2) '3)"};
+    Tokenizer tokenizer{&ss};
+    SymbolTable symbols;
+    Heap heap;
+    auto list = Read(&tokenizer, &symbols, &heap, &arena);
+
+    REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == 1);
+    auto pair = As<Cell>(As<Cell>(list)->GetSecond())->GetFirst();
+    REQUIRE(As<Cell>(pair)->GetFirst() == symbols.Intern("foo"));
+    REQUIRE(As<Number>(As<Cell>(pair)->GetSecond())->GetValue() == 2);
+    REQUIRE(heap.GetStats().objects_live == 0);
+}
+
+TEST_CASE("Deep nesting") {
+    constexpr size_t kDepth = 200000;
+    std::string source = std::string(kDepth, '(') + "1" + std::string(kDepth, ')');
+    auto list = ReadFull(source);
+    for (size_t i = 0; i < kDepth; ++i) {
+        REQUIRE(Is<Cell>(list));
+        list = As<Cell>(list)->GetFirst();
+    }
+    REQUIRE(As<Number>(list)->GetValue() == 1);
+
+    Tokenizer tokenizer{std::string_view(source)};
+    SymbolTable symbols;
+    Heap heap;
+    REQUIRE_THROWS_AS(Read(&tokenizer, &symbols, &heap, nullptr, kDepth - 1), SyntaxError);
+
+    Tokenizer quotes{std::string_view("'''1")};
+    REQUIRE_THROWS_AS(Read(&quotes, &symbols, &heap, nullptr, 2), SyntaxError);
+}
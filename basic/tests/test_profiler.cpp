@@ -0,0 +1,96 @@
+#include "scheme_test.h"
+
+#include <parser.h>
+#include <profiler.h>
+
+#include <chrono>
+
+namespace {
+
+InterpreterOptions ProfiledOptions(SamplingProfiler* profiler) {
+    auto options = TestInterpreterOptions();
+    options.profiler = profiler;
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("Profiler records the calls being evaluated") {
+    // The timer never fires during the test; samples come on request only.
+    SamplingProfiler profiler(std::chrono::hours(1));
+    Interpreter interpreter{ProfiledOptions(&profiler)};
+
+    profiler.RequestSample();
+    REQUIRE(interpreter.Run("(+ 1 (max 2 (abs -3)))") == "4");
+#ifdef SCHEME_TEST_BYTECODE
+    // The VM has no call frames to sample.
+    REQUIRE(profiler.GetSampleCount() == 0);
+#else
+    REQUIRE(profiler.GetFoldedStacks() == "+@1:1 1\n");
+
+    profiler.RequestSample();
+    interpreter.Run("(+ 1 (max 2 (abs -3)))");
+    profiler.RequestSample();
+    interpreter.Run("(+ 1 (max 2 (abs -3)))");
+    REQUIRE(profiler.GetFoldedStacks() == "+@1:1 3\n");
+    REQUIRE(profiler.GetSampleCount() == 3);
+
+    // Once nothing is being evaluated, a sample waits for the next call.
+    profiler.Reset();
+    REQUIRE_THROWS_AS(interpreter.Run("(car '())"), RuntimeError);
+    profiler.RequestSample();
+    interpreter.Run("(min 1 2)");
+    REQUIRE(profiler.GetFoldedStacks() == "min@1:1 1\n");
+#endif
+}
+
+// The VM has no call frames, so this would only wait out the deadline.
+#ifndef SCHEME_TEST_BYTECODE
+TEST_CASE("Profiler samples on a timer") {
+    SamplingProfiler profiler(std::chrono::microseconds(100));
+    Interpreter interpreter{ProfiledOptions(&profiler)};
+
+    std::string expression = "(+ 1";
+    for (int i = 0; i < 200; ++i) {
+        expression += " (max 1 (abs -" + std::to_string(i) + "))";
+    }
+    expression += ")";
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (profiler.GetSampleCount() < 20 && std::chrono::steady_clock::now() < deadline) {
+        interpreter.Run(expression);
+    }
+    REQUIRE(profiler.GetSampleCount() >= 20);
+    auto folded = profiler.GetFoldedStacks();
+    // Every line is a stack under the outer call.
+    size_t begin = 0;
+    while (begin < folded.size()) {
+        auto end = folded.find('\n', begin);
+        auto line = folded.substr(begin, end - begin);
+        REQUIRE(line.starts_with("+"));
+        REQUIRE(line.find(' ') != std::string::npos);
+        begin = end + 1;
+    }
+}
+#endif
+
+TEST_CASE("Work taken over from another thread is sampled on its own") {
+    SamplingProfiler outer(std::chrono::hours(1));
+    SamplingProfiler inner(std::chrono::hours(1));
+    SymbolTable symbols;
+    Heap heap;
+    Tokenizer tokenizer{std::string_view("((f 1) (g 2))")};
+    auto calls = Read(&tokenizer, &symbols, &heap);
+    auto f = As<Cell>(As<Cell>(calls)->GetFirst());
+    auto g = As<Cell>(As<Cell>(As<Cell>(calls)->GetSecond())->GetFirst());
+
+    {
+        SamplingProfiler::Scope waiting(&outer, f, nullptr);
+        SamplingProfiler::SetAsideScope set_aside;
+        outer.RequestSample();
+        inner.RequestSample();
+        SamplingProfiler::Scope stolen(&inner, g, nullptr);
+    }
+    REQUIRE(inner.GetFoldedStacks() == "g 1\n");
+    REQUIRE(outer.GetFoldedStacks() == "f 1\n");
+}
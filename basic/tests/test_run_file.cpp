@@ -0,0 +1,57 @@
+#include "scheme_test.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class RunFileTest {
+public:
+    RunFileTest() : path_(std::filesystem::temp_directory_path() / "scheme_run_file_test.scm") {
+    }
+
+    ~RunFileTest() {
+        std::filesystem::remove(path_);
+    }
+
+    std::string RunFile(const std::string& source) {
+        std::ofstream(path_) << source;
+        std::stringstream out;
+        interpreter_.RunFile(path_.string(), &out);
+        return out.str();
+    }
+
+private:
+    std::filesystem::path path_;
+    Interpreter interpreter_{TestInterpreterOptions()};
+};
+
+TEST_CASE_METHOD(RunFileTest, "RunFile evaluates every top-level form") {
+    REQUIRE(RunFile("(+ 1 2)\n'(1 2 . 3)\n\n  (list? '(1 2)) 4") == "3\n(1 2 . 3)\n#t\n4\n");
+    REQUIRE(RunFile("").empty());
+    REQUIRE(RunFile("\n\n").empty());
+}
+
+TEST_CASE_METHOD(RunFileTest, "RunFile errors") {
+    REQUIRE_THROWS_AS(RunFile("(+ 1 2) (1 2"), SyntaxError);
+    REQUIRE_THROWS_AS(RunFile("1 (1 2)"), RuntimeError);
+}
+
+TEST_CASE("RunForm takes one form at a time from a stream") {
+    Interpreter interpreter{TestInterpreterOptions()};
+    std::stringstream in;
+    Tokenizer tokenizer{&in};
+    in << "(+ 1 2)";
+    std::string out;
+    Printer printer(&out);
+
+    interpreter.RunForm(&tokenizer, &printer);
+    REQUIRE(out == "3");
+
+    // Nothing past the form has been asked of the stream, so it can go on.
+    in << " '(4\n5) (* 2";
+    interpreter.RunForm(&tokenizer, &printer);
+    REQUIRE(out == "3(4 5)");
+    REQUIRE(in.peek() == ' ');
+
+    REQUIRE_THROWS_AS(interpreter.RunForm(&tokenizer, &printer), SyntaxError);
+}
@@ -3,7 +3,9 @@
 #include <error.h>
 #include <tokenizer.h>
 
+#include <cstdint>
 #include <sstream>
+#include <vector>
 
 TEST_CASE("Tokenizer works on simple case") {
     std::stringstream ss{"4+)'."};
@@ -160,3 +162,157 @@ void ShouldThrow() {
 TEST_CASE("Exception is thrown") {
     REQUIRE_THROWS_AS(ShouldThrow(), SyntaxError);
 }
+
+TEST_CASE("Buffer tokenizer") {
+    SECTION("Simple case") {
+        Tokenizer tokenizer{std::string_view{"4+)'."}};
+
+        REQUIRE(tokenizer.GetToken() == Token{ConstantToken{4}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"+"}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{QuoteToken{}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{DotToken{}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.IsEnd());
+    }
+
+    SECTION("Symbols are views into the source") {
+        std::string source = "  zog-zog? -2 - ";
+        Tokenizer tokenizer{std::string_view{source}};
+
+        auto name = GetSymbolTokenValue(tokenizer.GetToken());
+        REQUIRE(name == "zog-zog?");
+        REQUIRE(name.data() == source.data() + 2);
+
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{ConstantToken{-2}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"-"}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.IsEnd());
+    }
+
+    SECTION("Errors") {
+        Tokenizer tokenizer{std::string_view{"1@"}};
+        REQUIRE_THROWS_AS(tokenizer.Next(), SyntaxError);
+
+        Tokenizer empty{std::string_view{"   "}};
+        REQUIRE(empty.IsEnd());
+        REQUIRE_THROWS_AS(empty.GetToken(), SyntaxError);
+    }
+
+    SECTION("Literals beyond int64 keep their digits") {
+        std::string source = "9223372036854775807 -9223372036854775808 9223372036854775808 "
+                             "-99999999999999999999 +18446744073709551616";
+        std::stringstream ss{source};
+        Tokenizer stream{&ss};
+        Tokenizer buffer{std::string_view{source}};
+
+        std::vector<Token> expected = {
+            ConstantToken{INT64_MAX},
+            ConstantToken{INT64_MIN},
+            ConstantToken{0, "9223372036854775808"},
+            ConstantToken{0, "-99999999999999999999"},
+            ConstantToken{0, "+18446744073709551616"},
+        };
+        for (const auto& token : expected) {
+            REQUIRE(buffer.GetToken() == token);
+            REQUIRE(stream.GetToken() == token);
+            buffer.Next();
+            stream.Next();
+        }
+        REQUIRE(buffer.IsEnd());
+        REQUIRE(stream.IsEnd());
+    }
+
+    SECTION("Agrees with the stream tokenizer") {
+        std::string source = "(define (f x) '(1 . -2) #t +3 <= a1!)\n(- x)";
+        std::stringstream ss{source};
+        Tokenizer stream{&ss};
+        Tokenizer buffer{std::string_view{source}};
+
+        while (!stream.IsEnd()) {
+            REQUIRE(!buffer.IsEnd());
+            REQUIRE(stream.GetToken() == buffer.GetToken());
+            stream.Next();
+            buffer.Next();
+        }
+        REQUIRE(buffer.IsEnd());
+    }
+}
+
+TEST_CASE("Source positions") {
+    std::string source = "(+ 1\n  foo)\n\n -12 ";
+    std::vector<SourcePosition> expected = {
+        {0, 1, 1}, {1, 1, 2}, {3, 1, 4}, {7, 2, 3}, {10, 2, 6}, {14, 4, 2},
+    };
+
+    SECTION("Token starts") {
+        std::stringstream ss{source};
+        Tokenizer stream{&ss};
+        Tokenizer buffer{std::string_view{source}};
+        for (const auto& position : expected) {
+            REQUIRE(buffer.GetPosition() == position);
+            REQUIRE(stream.GetPosition() == position);
+            REQUIRE(LocateOffset(source, position.offset) == position);
+            buffer.Next();
+            stream.Next();
+        }
+        REQUIRE(buffer.IsEnd());
+        REQUIRE(stream.IsEnd());
+        REQUIRE(buffer.GetPosition() == SourcePosition{18, 4, 6});
+        REQUIRE(stream.GetPosition() == SourcePosition{18, 4, 6});
+    }
+
+    SECTION("Line index") {
+        LineIndex index(source);
+        for (size_t offset : {10, 3, 18, 0, 14, 7, 11}) {
+            REQUIRE(index.Locate(offset) == LocateOffset(source, offset));
+        }
+    }
+
+    SECTION("Errors point at the offending character") {
+        Tokenizer buffer{std::string_view{"(+ 1\n  @)"}};
+        auto read_all = [&buffer] {
+            while (!buffer.IsEnd()) {
+                buffer.GetToken();
+                buffer.Next();
+            }
+        };
+        REQUIRE_THROWS_WITH(read_all(), "Wrong Syntax at 2:3");
+    }
+}
+
+TEST_CASE("Consume does not look ahead") {
+    std::stringstream ss{"(1) @"};
+    Tokenizer tokenizer{&ss};
+    for (int i = 0; i < 3; ++i) {
+        tokenizer.GetToken();
+        tokenizer.Consume();
+    }
+    REQUIRE(ss.peek() == ' ');
+    REQUIRE_THROWS_AS(tokenizer.GetToken(), SyntaxError);
+}
+
+TEST_CASE("Reading carries on past a bad line") {
+    std::string source = "(1 @ 2)\n(3)";
+    std::stringstream ss{source};
+    Tokenizer stream{&ss};
+    Tokenizer buffer{std::string_view{source}};
+    for (auto* tokenizer : {&stream, &buffer}) {
+        for (int i = 0; i < 2; ++i) {
+            tokenizer->GetToken();
+            tokenizer->Consume();
+        }
+        REQUIRE_THROWS_AS(tokenizer->GetToken(), SyntaxError);
+        tokenizer->SkipLine();
+        REQUIRE(tokenizer->GetToken() == Token{BracketToken::OPEN});
+        REQUIRE(tokenizer->GetPosition() == SourcePosition{8, 2, 1});
+        tokenizer->SkipLine();
+        REQUIRE(tokenizer->IsEnd());
+    }
+}
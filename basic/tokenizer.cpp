@@ -1,6 +1,9 @@
 #include <tokenizer.h>
 #include <error.h>
 
+#include <algorithm>
+#include <array>
+
 bool SymbolToken::operator==(const SymbolToken& other) const {
     return name == other.name;
 }
@@ -13,151 +16,335 @@ bool DotToken::operator==(const DotToken&) const {
 }
 
 bool ConstantToken::operator==(const ConstantToken& other) const {
-    return value == other.value;
+    return value == other.value && digits == other.digits;
 }
 
-Tokenizer::Tokenizer(std::istream* in) : in_(in) {
+bool IsConstantToken(const Token& token) {
+    return std::holds_alternative<ConstantToken>(token);
 }
 
-void KillSpaces(std::istream* in) {
-    while (in->peek() == ' ' || in->peek() == '\n') {  // get rid of spaces
-        in->get();
-    }
+bool IsSymbolToken(const Token& token) {
+    return std::holds_alternative<SymbolToken>(token);
 }
 
-bool Tokenizer::IsEnd() {
-    KillSpaces(in_);
-    return in_->peek() == EOF;
+int64_t GetConstantTokenValue(const Token& token) {
+    return std::get<ConstantToken>(token).value;
 }
 
-bool IsConstantToken(Token token) {
-    return std::holds_alternative<ConstantToken>(token);
+std::string_view GetConstantTokenDigits(const Token& token) {
+    return std::get<ConstantToken>(token).digits;
 }
 
-bool IsSymbolToken(Token token) {
-    return std::holds_alternative<SymbolToken>(token);
+std::string_view GetSymbolTokenValue(const Token& token) {
+    return std::get<SymbolToken>(token).name;
 }
 
-int GetConstantTokenValue(Token token) {
-    return std::get<ConstantToken>(token).value;
+SourcePosition LocateOffset(std::string_view text, size_t offset) {
+    auto prefix = text.substr(0, offset);
+    auto line_start = prefix.rfind('\n');
+    line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+    return SourcePosition{offset, size_t(std::count(prefix.begin(), prefix.end(), '\n')) + 1,
+                          offset - line_start + 1};
 }
 
-std::string GetSymbolTokenValue(Token token) {
-    return std::get<SymbolToken>(token).name;
+LineIndex::LineIndex(std::string_view text) : text_(text) {
 }
 
-bool IsDigit(char c) {
-    return c >= '0' && c <= '9';
+std::string_view LineIndex::GetText() const {
+    return text_;
 }
 
-void Tokenizer::Next() {
-    if (IsEnd()) {
-        return;
+SourcePosition LineIndex::Locate(size_t offset) {
+    std::lock_guard lock(mutex_);
+    while (scanned_ < offset) {
+        auto end = text_.find('\n', scanned_);
+        if (end == std::string_view::npos || end >= offset) {
+            scanned_ = offset;
+            break;
+        }
+        scanned_ = end + 1;
+        line_starts_.push_back(scanned_);
     }
-    Token cur = GetToken();
-    size_t cnt_move = 1;
-    if (IsConstantToken(cur)) {
-        std::string str = std::to_string(GetConstantTokenValue(cur));
-        cnt_move = str.size();
-    } else if (IsSymbolToken(cur)) {
-        std::string str = GetSymbolTokenValue(cur);
-        cnt_move = str.size();
+    auto after = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    size_t line = after - line_starts_.begin();
+    size_t line_start = line == 0 ? 0 : line_starts_[line - 1];
+    return SourcePosition{offset, line + 1, offset - line_start + 1};
+}
+
+std::string FormatSourcePosition(const SourcePosition& position) {
+    return std::to_string(position.line) + ":" + std::to_string(position.column);
+}
+
+namespace {
+
+enum CharClass : unsigned char {
+    kSpace = 1,
+    kDigit = 2,
+    kSymbolStart = 4,
+    kSymbolMid = 8,
+};
+
+constexpr std::array<unsigned char, 256> MakeCharClasses() {
+    std::array<unsigned char, 256> classes{};
+    classes[' '] = classes['\n'] = kSpace;
+    for (int c = '0'; c <= '9'; ++c) {
+        classes[c] = kDigit | kSymbolMid;
     }
-    while (cnt_move) {
-        in_->get();
-        --cnt_move;
+    for (int c = 'a'; c <= 'z'; ++c) {
+        classes[c] = classes[c - 'a' + 'A'] = kSymbolStart | kSymbolMid;
     }
-    if (IsConstantToken(cur) && IsDigit(in_->peek())) {
-        in_->get();
+    for (char c : std::string_view("<=>*/#")) {
+        classes[static_cast<unsigned char>(c)] = kSymbolStart | kSymbolMid;
     }
-    if (!IsEnd()) {
-        GetToken();
+    for (char c : std::string_view("!-?")) {
+        classes[static_cast<unsigned char>(c)] = kSymbolMid;
     }
+    return classes;
 }
 
-void PutBack(std::string& did_read, std::istream* in) {
-    while (!did_read.empty()) {
-        in->putback(did_read.back());
-        did_read.pop_back();
+constexpr auto kCharClasses = MakeCharClasses();
+
+bool Has(int c, CharClass cls) {
+    return c != EOF && (kCharClasses[static_cast<unsigned char>(c)] & cls);
+}
+
+// Accumulates one more digit of a literal's magnitude. Returns false once the
+// magnitude overflows, and must not be called again after that.
+bool PushDigit(uint64_t* magnitude, char digit) {
+    return !__builtin_mul_overflow(*magnitude, 10, magnitude) &&
+           !__builtin_add_overflow(*magnitude, digit - '0', magnitude);
+}
+
+// text is the literal as written, sign included. The token keeps it only when
+// the value does not fit into int64_t.
+ConstantToken MakeConstant(uint64_t magnitude, bool fits, bool negative, std::string_view text) {
+    uint64_t limit = (uint64_t{1} << 63) - (negative ? 0 : 1);
+    if (!fits || magnitude > limit) {
+        return ConstantToken{0, text};
     }
+    return ConstantToken{static_cast<int64_t>(negative ? uint64_t{0} - magnitude : magnitude)};
+}
+
+}  // namespace
+
+Tokenizer::Tokenizer(std::istream* in) : in_(in) {
+}
+
+Tokenizer::Tokenizer(std::string_view source) : source_(source) {
 }
 
-ConstantToken ReadConstantToken(std::string& did_read, std::istream* in) {
-    while (IsDigit(in->peek())) {
-        did_read.push_back(in->get());
+Tokenizer::Tokenizer(std::string_view source, const SourcePosition& start)
+    : source_(source),
+      offset_(start.offset),
+      line_(start.line),
+      line_start_(start.offset + 1 - start.column) {
+}
+
+// Returns true if there is anything left after the spaces.
+bool Tokenizer::SkipSpaces() {
+    if (!in_) {
+        while (pos_ < source_.size() && Has(source_[pos_], kSpace)) {
+            if (source_[pos_++] == '\n') {
+                ++line_;
+                line_start_ = offset_ + pos_;
+            }
+        }
+        return pos_ < source_.size();
     }
-    ConstantToken ret{std::stoi(did_read)};
-    PutBack(did_read, in);
-    return ret;
+    while (Has(in_->peek(), kSpace)) {
+        if (StreamGet() == '\n') {
+            ++line_;
+            line_start_ = pos_;
+        }
+    }
+    return in_->peek() != EOF;
+}
+
+int Tokenizer::StreamGet() {
+    ++pos_;
+    return in_->get();
+}
+
+SourcePosition Tokenizer::GetCursorPosition() const {
+    return SourcePosition{offset_ + pos_, line_, offset_ + pos_ - line_start_ + 1};
+}
+
+void Tokenizer::ThrowSyntaxError() {
+    throw SyntaxError("Wrong Syntax at " + FormatSourcePosition(GetCursorPosition()));
 }
 
-bool IsSymbolStart(char c) {
-    static std::string symbols = "<=>*/#";
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
-           (symbols.find(c) != std::string::npos);
+bool Tokenizer::IsEnd() {
+    return !current_ && !SkipSpaces();
 }
 
-bool IsSymbolMid(char c) {
-    return IsSymbolStart(c) || IsDigit(c) || c == '!' || c == '-' || c == '?';
+void Tokenizer::Next() {
+    Consume();
+    if (!IsEnd()) {
+        Lex();
+    }
 }
 
-SymbolToken ReadSymbolToken(std::string& did_read, std::istream* in) {
-    while (IsSymbolMid(in->peek())) {
-        did_read.push_back(in->get());
+void Tokenizer::Consume() {
+    if (!current_) {
+        if (IsEnd()) {
+            return;
+        }
+        Lex();
     }
-    SymbolToken ret{did_read};
-    PutBack(did_read, in);
-    return ret;
+    current_.reset();
 }
 
 Token Tokenizer::GetToken() {
-    KillSpaces(in_);
+    if (!current_) {
+        Lex();
+    }
+    return *current_;
+}
+
+void Tokenizer::SkipLine() {
+    current_.reset();
+    int c = 0;
+    if (!in_) {
+        while (pos_ < source_.size() && c != '\n') {
+            c = source_[pos_++];
+        }
+    } else {
+        while (c != '\n' && in_->peek() != EOF) {
+            c = StreamGet();
+        }
+    }
+    if (c == '\n') {
+        ++line_;
+        line_start_ = offset_ + pos_;
+    }
+}
+
+SourcePosition Tokenizer::GetPosition() {
+    if (current_) {
+        return token_position_;
+    }
+    SkipSpaces();
+    return GetCursorPosition();
+}
+
+void Tokenizer::Lex() {
+    if (!SkipSpaces()) {
+        ThrowSyntaxError();
+    }
+    token_position_ = GetCursorPosition();
+    if (in_) {
+        LexStream();
+    } else {
+        LexBuffer();
+    }
+}
 
-    std::string did_read;
+void Tokenizer::LexBuffer() {
+    const char* begin = source_.data() + pos_;
+    const char* end = source_.data() + source_.size();
+    const char* cur = begin;
+    char first_char = *cur++;
+
+    if (first_char == '(') {
+        current_ = BracketToken::OPEN;
+    } else if (first_char == ')') {
+        current_ = BracketToken::CLOSE;
+    } else if (first_char == '\'') {
+        current_ = QuoteToken();
+    } else if (first_char == '.') {
+        current_ = DotToken();
+    } else if (Has(first_char, kDigit) ||
+               ((first_char == '+' || first_char == '-') && cur != end && Has(*cur, kDigit))) {
+        uint64_t magnitude = 0;
+        bool fits = true;
+        if (Has(first_char, kDigit)) {
+            magnitude = first_char - '0';
+        }
+        while (cur != end && Has(*cur, kDigit)) {
+            fits = fits && PushDigit(&magnitude, *cur);
+            ++cur;
+        }
+        current_ = MakeConstant(magnitude, fits, first_char == '-',
+                                std::string_view(begin, cur - begin));
+    } else if (first_char == '+' || first_char == '-') {
+        current_ = SymbolToken{std::string_view(begin, 1)};
+    } else if (Has(first_char, kSymbolStart)) {
+        while (cur != end && Has(*cur, kSymbolMid)) {
+            ++cur;
+        }
+        current_ = SymbolToken{std::string_view(begin, cur - begin)};
+    } else {
+        ThrowSyntaxError();
+    }
+    pos_ += cur - begin;
+}
+
+// Reads the digits of a literal after whatever symbol_ already holds of it.
+void Tokenizer::LexStreamDigits(bool negative) {
+    uint64_t magnitude = 0;
+    bool fits = true;
+    while (Has(in_->peek(), kDigit)) {
+        symbol_.push_back(StreamGet());
+        fits = fits && PushDigit(&magnitude, symbol_.back());
+    }
+    current_ = MakeConstant(magnitude, fits, negative, symbol_);
+}
+
+void Tokenizer::LexStream() {
     char first_char = in_->peek();
+
     if (first_char == '(') {
-        return BracketToken::OPEN;
+        current_ = BracketToken::OPEN;
     } else if (first_char == ')') {
-        return BracketToken::CLOSE;
+        current_ = BracketToken::CLOSE;
     } else if (first_char == '\'') {
-        return QuoteToken();
+        current_ = QuoteToken();
     } else if (first_char == '.') {
-        return DotToken();
-    } else if (IsDigit(first_char)) {
-        return ReadConstantToken(did_read, in_);
+        current_ = DotToken();
+    } else if (Has(first_char, kDigit)) {
+        symbol_.clear();
+        LexStreamDigits(false);
+        return;
     } else if (first_char == '+' || first_char == '-') {
-        did_read.push_back(in_->get());
-        if (IsDigit(in_->peek())) {
-            return ReadConstantToken(did_read, in_);
-        } else {
-            PutBack(did_read, in_);
-            return SymbolToken{std::string(1, first_char)};
+        StreamGet();
+        symbol_.assign(1, first_char);
+        if (!Has(in_->peek(), kDigit)) {
+            current_ = SymbolToken{symbol_};
+            return;
+        }
+        LexStreamDigits(first_char == '-');
+        return;
+    } else if (Has(first_char, kSymbolStart)) {
+        symbol_.clear();
+        while (Has(in_->peek(), kSymbolMid)) {
+            symbol_.push_back(StreamGet());
         }
-    } else if (IsSymbolStart(first_char)) {
-        return ReadSymbolToken(did_read, in_);
+        current_ = SymbolToken{symbol_};
+        return;
     } else {
-        throw SyntaxError("Wrong Syntax");
+        ThrowSyntaxError();
     }
+    StreamGet();
 }
 
-bool IsOpenBracket(Token token) {
+bool IsOpenBracket(const Token& token) {
     if (std::holds_alternative<BracketToken>(token)) {
         return std::get<BracketToken>(token) == BracketToken::OPEN;
     }
     return false;
 }
 
-bool IsCloseBracket(Token token) {
+bool IsCloseBracket(const Token& token) {
     if (std::holds_alternative<BracketToken>(token)) {
         return std::get<BracketToken>(token) == BracketToken::CLOSE;
     }
     return false;
 }
 
-bool IsDotToken(Token token) {
+bool IsDotToken(const Token& token) {
     return std::holds_alternative<DotToken>(token);
 }
 
-bool IsQuoteToken(Token token) {
+bool IsQuoteToken(const Token& token) {
     return std::holds_alternative<QuoteToken>(token);
-}
\ No newline at end of file
+}
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <variant>
 #include <optional>
 #include <istream>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
+// Symbol names are views: into the source buffer for buffer tokenizers, or
+// into the tokenizer's own storage for stream tokenizers. In the latter case
+// the view is valid until the next call to Next().
 struct SymbolToken {
-    std::string name;
+    std::string_view name;
 
     bool operator==(const SymbolToken& other) const;
 };
@@ -21,40 +28,127 @@ struct DotToken {
 
 enum class BracketToken { OPEN, CLOSE };
 
+// A literal that does not fit into int64_t has value 0 and keeps its text,
+// sign included, in digits. The view follows the same rules as symbol names.
 struct ConstantToken {
-    int value;
+    int64_t value;
+    std::string_view digits = {};
 
     bool operator==(const ConstantToken& other) const;
 };
 
 using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
 
+// Lines and columns count from 1, offsets from 0, all in bytes.
+struct SourcePosition {
+    size_t offset = 0;
+    size_t line = 1;
+    size_t column = 1;
+
+    bool operator==(const SourcePosition&) const = default;
+};
+
+// Where offset falls in text. Takes time linear in offset, so meant for
+// reporting rather than for every token.
+SourcePosition LocateOffset(std::string_view text, size_t offset);
+
+// Locates many offsets in one text, going over the text at most once in
+// all: the lines are found as far as the furthest offset asked for so far.
+// The text must outlive the index. Safe to use from several threads.
+class LineIndex {
+public:
+    explicit LineIndex(std::string_view text);
+
+    std::string_view GetText() const;
+
+    // offset must be at most the size of the text.
+    SourcePosition Locate(size_t offset);
+
+private:
+    std::string_view text_;
+    std::mutex mutex_;
+    // Offsets at which lines after the first start, up to scanned_.
+    std::vector<size_t> line_starts_;
+    size_t scanned_ = 0;
+};
+
+// As "line:column".
+std::string FormatSourcePosition(const SourcePosition& position);
+
 class Tokenizer {
 public:
     Tokenizer(std::istream* in);
 
+    // Lexes straight from the buffer, which must outlive the tokenizer.
+    explicit Tokenizer(std::string_view source);
+
+    // Lexes source as a piece of a larger input that it sits at start of,
+    // so that positions and errors refer to that input.
+    Tokenizer(std::string_view source, const SourcePosition& start);
+
     bool IsEnd();
 
     void Next();
 
+    // Like Next, but leaves the token after this one unread until it is
+    // asked for. A reader stopping at the end of a form then does not wait
+    // for a stream to deliver more.
+    void Consume();
+
     Token GetToken();
 
+    // Drops the current token and the rest of the line the cursor is on,
+    // so that reading can carry on after a syntax error.
+    void SkipLine();
+
+    // Where the token GetToken returns starts, or where the input ends if
+    // there is none.
+    SourcePosition GetPosition();
+
 private:
-    std::istream* in_;
+    // Consumes the token under the cursor and stores it in current_.
+    void Lex();
+    void LexBuffer();
+    void LexStream();
+    void LexStreamDigits(bool negative);
+
+    bool SkipSpaces();
+    // Takes the next character from the stream, keeping count.
+    int StreamGet();
+    SourcePosition GetCursorPosition() const;
+    [[noreturn]] void ThrowSyntaxError();
+
+    std::istream* in_ = nullptr;
+    std::string_view source_;
+    // Characters consumed so far, in either mode.
+    size_t pos_ = 0;
+    // Offset of the first character in the whole input.
+    size_t offset_ = 0;
+    // Only spaces may hold line breaks, so lines are counted while skipping
+    // them. line_start_ is an offset in the whole input.
+    size_t line_ = 1;
+    size_t line_start_ = 0;
+    SourcePosition token_position_;
+
+    std::string symbol_;
+    std::optional<Token> current_;
 };
 
-bool IsConstantToken(Token token);
+bool IsConstantToken(const Token& token);
+
+int64_t GetConstantTokenValue(const Token& token);
 
-int GetConstantTokenValue(Token token);
+// Empty unless the literal does not fit into int64_t.
+std::string_view GetConstantTokenDigits(const Token& token);
 
-bool IsSymbolToken(Token token);
+bool IsSymbolToken(const Token& token);
 
-std::string GetSymbolTokenValue(Token token);
+std::string_view GetSymbolTokenValue(const Token& token);
 
-bool IsOpenBracket(Token token);
+bool IsOpenBracket(const Token& token);
 
-bool IsCloseBracket(Token token);
+bool IsCloseBracket(const Token& token);
 
-bool IsDotToken(Token token);
+bool IsDotToken(const Token& token);
 
-bool IsQuoteToken(Token token);
\ No newline at end of file
+bool IsQuoteToken(const Token& token);
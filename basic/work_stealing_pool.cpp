@@ -0,0 +1,186 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+namespace {
+
+// Which pool the current thread works for, if any, and its index there.
+thread_local const void* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+}  // namespace
+
+struct WorkStealingPool::Job {
+    const std::function<void(size_t, size_t)>* body;
+    std::atomic<size_t> pending;
+    // The waiting thread sleeps on done once it has nothing left to run.
+    std::mutex done_mutex;
+    std::condition_variable done;
+
+    // Chunks starting past the lowest failed one are not run; they could
+    // only fail later than it.
+    std::atomic<size_t> failed_at = std::numeric_limits<size_t>::max();
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+WorkStealingPool::WorkStealingPool(size_t workers) {
+    for (size_t i = 0; i <= workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+WorkStealingPool& WorkStealingPool::Shared() {
+    static WorkStealingPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+size_t WorkStealingPool::GetConcurrency() const {
+    return workers_.size() + 1;
+}
+
+void WorkStealingPool::ParallelFor(size_t count, size_t chunk,
+                                   const std::function<void(size_t, size_t)>& body) {
+    chunk = std::max<size_t>(chunk, 1);
+    if (workers_.empty() || count <= chunk) {
+        for (size_t begin = 0; begin < count; begin += chunk) {
+            body(begin, std::min(begin + chunk, count));
+        }
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    size_t chunks = (count + chunk - 1) / chunk;
+    job.pending.store(chunks, std::memory_order_relaxed);
+
+    // Pushed last to first: the owner pops from the back and so goes through
+    // the range in order, while thieves take the far end.
+    Queue* local = GetLocalQueue();
+    {
+        std::lock_guard lock(local->mutex);
+        for (size_t i = chunks; i-- > 0;) {
+            local->tasks.push_back({&job, i * chunk, std::min((i + 1) * chunk, count)});
+        }
+    }
+    {
+        std::lock_guard lock(sleep_mutex_);
+        queued_.fetch_add(chunks, std::memory_order_relaxed);
+    }
+    wake_.notify_all();
+
+    // The tasks run while waiting may belong to other jobs, e.g. the ones
+    // nested in this job's chunks. Once none are left to take, the rest of
+    // this job is running on other threads, and there is nothing to do but
+    // sleep until it finishes.
+    while (job.pending.load(std::memory_order_acquire) > 0) {
+        Task task;
+        if (PopLocal(local, &task) || Steal(local, &task)) {
+            Run(task);
+            continue;
+        }
+        std::unique_lock lock(job.done_mutex);
+        job.done.wait(lock, [&job] { return job.pending.load(std::memory_order_acquire) == 0; });
+    }
+    // The last chunk may still be notifying; it is done with the job once
+    // it lets go of the mutex.
+    std::lock_guard lock(job.done_mutex);
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+void WorkStealingPool::WorkerLoop(size_t index) {
+    current_pool = this;
+    current_worker = index;
+    Queue* local = queues_[index + 1].get();
+    while (true) {
+        Task task;
+        if (PopLocal(local, &task) || Steal(local, &task)) {
+            Run(task);
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stop_ && queued_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+WorkStealingPool::Queue* WorkStealingPool::GetLocalQueue() {
+    if (current_pool == this) {
+        return queues_[current_worker + 1].get();
+    }
+    return queues_[0].get();
+}
+
+bool WorkStealingPool::PopLocal(Queue* local, Task* task) {
+    std::lock_guard lock(local->mutex);
+    if (local->tasks.empty()) {
+        return false;
+    }
+    *task = local->tasks.back();
+    local->tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkStealingPool::Steal(Queue* local, Task* task) {
+    // Victims are tried starting just past the thief, so that thieves spread
+    // out instead of all hitting the same queue.
+    size_t start = current_pool == this ? current_worker + 1 : 0;
+    for (size_t i = 1; i <= queues_.size(); ++i) {
+        Queue* victim = queues_[(start + i) % queues_.size()].get();
+        if (victim == local) {
+            continue;
+        }
+        std::lock_guard lock(victim->mutex);
+        if (victim->tasks.empty()) {
+            continue;
+        }
+        *task = victim->tasks.front();
+        victim->tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(const Task& task) {
+    Job* job = task.job;
+    if (task.begin < job->failed_at.load(std::memory_order_relaxed)) {
+        try {
+            (*job->body)(task.begin, task.end);
+        } catch (...) {
+            std::lock_guard lock(job->error_mutex);
+            if (task.begin < job->failed_at.load(std::memory_order_relaxed)) {
+                job->failed_at.store(task.begin, std::memory_order_relaxed);
+                job->error = std::current_exception();
+            }
+        }
+    }
+    // The job lives on the stack of the thread waiting for it, which only
+    // returns after taking done_mutex, so nothing here can outlive it.
+    std::lock_guard lock(job->done_mutex);
+    if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        job->done.notify_all();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for data-parallel loops. Every worker has its own deque of
+// chunks: it takes new work from the back of its own deque and, when that
+// runs dry, steals from the front of the others. A thread waiting for its
+// loop to finish runs chunks meanwhile, so loops may nest freely.
+class WorkStealingPool {
+public:
+    // Starts this many worker threads; a thread calling ParallelFor takes
+    // part as well.
+    explicit WorkStealingPool(size_t workers);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Process-wide pool with one worker per hardware thread but one, started
+    // on first use.
+    static WorkStealingPool& Shared();
+
+    // Threads that can run chunks at once, the calling one included.
+    size_t GetConcurrency() const;
+
+    // Calls body(begin, end) for consecutive chunks of [0, count), at most
+    // chunk indices each, and returns once every chunk is done. If body
+    // throws, the remaining chunks after it are skipped and the exception
+    // from the chunk with the lowest begin is rethrown, so the error is the
+    // same one a sequential loop would have hit first.
+    void ParallelFor(size_t count, size_t chunk, const std::function<void(size_t, size_t)>& body);
+
+private:
+    struct Job;
+
+    struct Task {
+        Job* job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(size_t index);
+    // The queue the calling thread pushes to: its own for a worker, the
+    // shared one for any other thread.
+    Queue* GetLocalQueue();
+    bool PopLocal(Queue* local, Task* task);
+    bool Steal(Queue* local, Task* task);
+    void Run(const Task& task);
+
+    // queues_[0] is shared by threads from outside the pool, the rest belong
+    // to the workers in order.
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // Sleeping workers wait until something is queued.
+    std::atomic<size_t> queued_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};